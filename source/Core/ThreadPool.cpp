@@ -0,0 +1,112 @@
+#include "Luzpch.hpp"
+
+#include "ThreadPool.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+
+namespace ThreadPool {
+
+struct ForState {
+    std::atomic<u32> next = 0;
+    std::atomic<u32> done = 0;
+    u32 count = 0;
+    const std::function<void(u32)>* func = nullptr;
+    std::mutex mutex;
+    std::condition_variable finished;
+
+    void Run() {
+        u32 processed = 0;
+        for (u32 i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+            (*func)(i);
+            processed++;
+        }
+        if (processed > 0 && done.fetch_add(processed) + processed == count) {
+            std::lock_guard lock(mutex);
+            finished.notify_all();
+        }
+    }
+};
+
+struct Pool {
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stop = false;
+
+    Pool() {
+        u32 count = std::max(1u, std::thread::hardware_concurrency()) - 1;
+        for (u32 i = 0; i < count; i++) {
+            workers.emplace_back([this] { WorkerLoop(); });
+        }
+    }
+
+    ~Pool() {
+        {
+            std::lock_guard lock(mutex);
+            stop = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    void WorkerLoop() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock lock(mutex);
+                wake.wait(lock, [this] { return stop || !tasks.empty(); });
+                if (stop && tasks.empty()) {
+                    return;
+                }
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+};
+
+static Pool& GetPool() {
+    static Pool pool;
+    return pool;
+}
+
+u32 WorkerCount() {
+    return (u32)GetPool().workers.size();
+}
+
+void ParallelFor(u32 count, const std::function<void(u32)>& func) {
+    if (count == 0) {
+        return;
+    }
+    Pool& pool = GetPool();
+    u32 helpers = std::min((u32)pool.workers.size(), count - 1);
+    if (helpers == 0) {
+        for (u32 i = 0; i < count; i++) {
+            func(i);
+        }
+        return;
+    }
+    // helpers that start after all indices were taken only touch the shared state
+    auto state = std::make_shared<ForState>();
+    state->count = count;
+    state->func = &func;
+    {
+        std::lock_guard lock(pool.mutex);
+        for (u32 i = 0; i < helpers; i++) {
+            pool.tasks.emplace_back([state] { state->Run(); });
+        }
+    }
+    pool.wake.notify_all();
+    state->Run();
+    std::unique_lock lock(state->mutex);
+    state->finished.wait(lock, [&] { return state->done.load() == count; });
+}
+
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include "Base.hpp"
+
+#include <functional>
+
+// Process wide pool of worker threads, created on first use.
+// The calling thread always takes part in the work, so nested calls are safe.
+namespace ThreadPool {
+
+u32 WorkerCount();
+
+// Runs func(i) for every i in [0, count) and returns when all calls finished.
+void ParallelFor(u32 count, const std::function<void(u32)>& func);
+
+}
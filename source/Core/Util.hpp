@@ -2,6 +2,7 @@
 
 #include "Base.hpp"
 
+#include <cstring>
 #include <string>
 #include <vector>
 
@@ -20,6 +21,33 @@ inline void HashCombine(u32& h, void* ptr, uint32_t size) {
     h = std::hash<std::string_view>()(std::string_view((char*)ptr, size));
 }
 
+// MurmurHash3 finalizer, every input bit affects every output bit
+inline u64 HashMix64(u64 x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    x ^= x >> 33;
+    return x;
+}
+
+inline u64 Hash64(const void* data, size_t size, u64 seed = 0) {
+    const u8* bytes = (const u8*)data;
+    u64 h = HashMix64(seed ^ (size * 0x9e3779b97f4a7c15ull));
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        u64 word;
+        memcpy(&word, bytes + i, 8);
+        h = HashMix64(h ^ word) + 0x9e3779b97f4a7c15ull;
+    }
+    if (i < size) {
+        u64 word = 0;
+        memcpy(&word, bytes + i, size - i);
+        h = HashMix64(h ^ word);
+    }
+    return HashMix64(h);
+}
+
 inline float Halton(uint32_t i, uint32_t b) {
     float f = 1.0f;
     float r = 0.0f;
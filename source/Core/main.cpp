@@ -45,6 +45,7 @@ private:
 
     std::chrono::high_resolution_clock::time_point lastFrameTime = {};
     std::chrono::high_resolution_clock::time_point lastCameraTime = {};
+    std::chrono::high_resolution_clock::time_point lastCollectTime = {};
 
     struct CacheData {
         char projectPath[1024] = "assets/default.luz";
@@ -120,10 +121,16 @@ private:
                 WriteCache();
             }
             if (const auto paths = Window::GetAndClearPaths(); paths.size()) {
-                auto newNodes = assetManager.AddAssetsToScene(scene, paths);
-                if (newNodes.size()) {
-                    editor.Select(assetManager, newNodes);
-                }
+                assetManager.ImportAsync(paths);
+            }
+            if (auto newNodes = assetManager.AddImportedAssets(scene); newNodes.size()) {
+                editor.Select(assetManager, newNodes);
+            }
+            // deleted nodes leave their assets behind, they're collected every few seconds
+            if (std::chrono::high_resolution_clock::now() - lastCollectTime > std::chrono::seconds(10)) {
+                assetManager.CollectGarbage();
+                gpuScene.CollectGarbage(assetManager, scene);
+                lastCollectTime = std::chrono::high_resolution_clock::now();
             }
             gpuScene.AddAssets(assetManager);
             // todo: focus camera on selected object
@@ -208,7 +215,7 @@ private:
             editor.ProfilerPanel();
             editor.AssetsPanel(assetManager);
             editor.DemoPanel();
-            editor.ScenePanel(scene);
+            editor.ScenePanel(assetManager, scene);
             editor.InspectorPanel(assetManager, camera, gpuScene);
             editor.DebugDrawPanel();
         } else {
@@ -244,12 +251,7 @@ private:
 
         {
             LUZ_PROFILE_NAMED("RenderModels");
-            auto& allModels = gpuScene.GetMeshModels();
-            for (GPUModel& model : allModels) {
-                constants.modelID = model.modelRID;
-                vkw::CmdPushConstants(&constants, sizeof(constants));
-                vkw::CmdDrawMesh(model.mesh.vertexBuffer, model.mesh.indexBuffer, model.mesh.indexCount);
-            }
+            DeferredRenderer::DrawOpaqueModels(gpuScene, scene, camera);
         }
 
         // todo: light gizmos
@@ -14,9 +14,11 @@ namespace DeferredRenderer {
 
 struct Context {
     vkw::Pipeline opaquePipeline;
+    vkw::Pipeline opaquePackedPipeline;
     vkw::Pipeline lightPipeline;
     vkw::Pipeline composePipeline;
     vkw::Pipeline shadowMapPipeline;
+    vkw::Pipeline shadowMapPackedPipeline;
     vkw::Pipeline ssvlPipeline;
     vkw::Pipeline shadowMapVolumetricLightPipeline;
     vkw::Pipeline lineRenderingPipeline;
@@ -44,14 +46,117 @@ struct Context {
 
 Context ctx;
 
+// describes what can be culled for a pass, frustum planes point inwards
+struct CullView {
+    glm::vec4 planes[6];
+    u32 planeCount = 0;
+    glm::vec3 eye = glm::vec3(0);
+    glm::vec3 direction = glm::vec3(0);
+    bool orthographic = false;
+    bool useCone = false;
+    // 1 culls clusters facing away from the view, -1 culls clusters facing it
+    float coneSign = 1.0f;
+    float maxDistance = FLT_MAX;
+};
+
+void SetFrustumPlanes(CullView& view, const glm::mat4& viewProj) {
+    glm::mat4 rows = glm::transpose(viewProj);
+    view.planes[0] = rows[3] + rows[0];
+    view.planes[1] = rows[3] - rows[0];
+    view.planes[2] = rows[3] + rows[1];
+    view.planes[3] = rows[3] - rows[1];
+    view.planes[4] = rows[2];
+    view.planes[5] = rows[3] - rows[2];
+    for (u32 i = 0; i < 6; i++) {
+        view.planes[i] /= glm::length(glm::vec3(view.planes[i]));
+    }
+    view.planeCount = 6;
+}
+
+bool IsMeshletVisible(const CullView& view, const MeshAsset::Meshlet& meshlet, const glm::mat4& modelMat, float scale, bool coneValid) {
+    glm::vec3 center = modelMat * glm::vec4(meshlet.center, 1.0f);
+    float radius = meshlet.radius * scale;
+    for (u32 i = 0; i < view.planeCount; i++) {
+        if (glm::dot(glm::vec3(view.planes[i]), center) + view.planes[i].w < -radius) {
+            return false;
+        }
+    }
+    if (glm::distance(center, view.eye) - radius > view.maxDistance) {
+        return false;
+    }
+    if (view.useCone && coneValid && meshlet.coneCutoff < 1.0f) {
+        glm::vec3 axis = glm::normalize(glm::mat3(modelMat) * meshlet.coneAxis) * view.coneSign;
+        if (view.orthographic) {
+            return glm::dot(view.direction, axis) <= meshlet.coneCutoff;
+        }
+        glm::vec3 toCenter = center - view.eye;
+        return glm::dot(toCenter, axis) < meshlet.coneCutoff * glm::length(toCenter) + radius;
+    }
+    return true;
+}
+
+// draws the visible meshlets of every model with the bound vertex layout, merging runs that are contiguous in the index buffer
+template<typename T>
+void DrawCulledModels(GPUScene& gpuScene, const CullView& view, bool clusterCulling, bool shadow, bool packed, T& constants) {
+    for (GPUModel& model : gpuScene.GetMeshModels()) {
+        if (model.mesh.packed != packed) {
+            continue;
+        }
+        constants.modelID = model.modelRID;
+        vkw::CmdPushConstants(&constants, sizeof(constants));
+        u32 firstIndex = 0;
+        u32 indexCount = model.mesh.indexCount;
+        u32 firstMeshlet = 0;
+        u32 meshletCount = model.mesh.meshlets ? u32(model.mesh.meshlets->size()) : 0;
+        if (model.mesh.lods && !model.mesh.lods->empty()) {
+            const MeshAsset::Lod& lod = (*model.mesh.lods)[shadow ? model.shadowLod : model.lod];
+            firstIndex = lod.firstIndex;
+            indexCount = lod.indexCount;
+            firstMeshlet = lod.firstMeshlet;
+            meshletCount = lod.meshletCount;
+        }
+        if (!clusterCulling || meshletCount == 0) {
+            vkw::CmdDrawMesh(model.mesh.vertexBuffer, model.mesh.indexBuffer, indexCount, firstIndex, model.mesh.indexType);
+            continue;
+        }
+        glm::vec3 axisScale = glm::vec3(glm::length(model.modelMat[0]), glm::length(model.modelMat[1]), glm::length(model.modelMat[2]));
+        float maxScale = glm::max(axisScale.x, glm::max(axisScale.y, axisScale.z));
+        float minScale = glm::min(axisScale.x, glm::min(axisScale.y, axisScale.z));
+        // normal cones only survive uniform scaling without mirroring
+        bool coneValid = maxScale - minScale <= 0.001f * maxScale && glm::determinant(glm::mat3(model.modelMat)) > 0.0f;
+        u32 runFirst = 0;
+        u32 runCount = 0;
+        for (u32 m = firstMeshlet; m < firstMeshlet + meshletCount; m++) {
+            const MeshAsset::Meshlet& meshlet = (*model.mesh.meshlets)[m];
+            if (!IsMeshletVisible(view, meshlet, model.modelMat, maxScale, coneValid)) {
+                continue;
+            }
+            if (runCount > 0 && runFirst + runCount == meshlet.firstIndex) {
+                runCount += meshlet.indexCount;
+                continue;
+            }
+            if (runCount > 0) {
+                vkw::CmdDrawMesh(model.mesh.vertexBuffer, model.mesh.indexBuffer, runCount, runFirst, model.mesh.indexType);
+            }
+            runFirst = meshlet.firstIndex;
+            runCount = meshlet.indexCount;
+        }
+        if (runCount > 0) {
+            vkw::CmdDrawMesh(model.mesh.vertexBuffer, model.mesh.indexBuffer, runCount, runFirst, model.mesh.indexType);
+        }
+    }
+}
+
 void CreatePipeline(vkw::Pipeline& pipeline, const vkw::PipelineDesc& desc) {
     bool should_update = false;
     for (auto& stage : desc.stages) {
         auto path = "source/Shaders/" + stage.path.string();
-        auto it = ctx.shaderVersions.find(path);
+        // stages are shared between pipelines, so versions are tracked per pipeline
+        auto key = desc.name + path;
+        auto it = ctx.shaderVersions.find(key);
         auto version = FileManager::GetFileVersion(path);
         if (it == ctx.shaderVersions.end() || version > it->second) {
-            ctx.shaderVersions[path] = version;
+            ctx.shaderVersions[key] = version;
             should_update = true;
         }
     }
@@ -87,6 +192,18 @@ void CreateShaders() {
         .useDepth = true,
         .depthFormat = {ctx.depth.format}
     });
+    CreatePipeline(ctx.opaquePackedPipeline, {
+        .point = vkw::PipelinePoint::Graphics,
+        .stages = {
+            {.stage = vkw::ShaderStage::Vertex, .path = "opaquePacked.vert"},
+            {.stage = vkw::ShaderStage::Fragment, .path = "opaque.frag"},
+        },
+        .name = "Opaque Packed Pipeline",
+        .vertexAttributes = {vkw::Format::RGBA16_snorm, vkw::Format::RGBA16_snorm, vkw::Format::RG16_sfloat},
+        .colorFormats = {ctx.albedo.format, ctx.normal.format, ctx.material.format, ctx.emission.format},
+        .useDepth = true,
+        .depthFormat = {ctx.depth.format}
+    });
     CreatePipeline(ctx.shadowMapPipeline, {
         .point = vkw::PipelinePoint::Graphics,
         .stages = {
@@ -101,6 +218,20 @@ void CreateShaders() {
         .depthFormat = { vkw::Format::D32_sfloat },
         .cullFront = true,
     });
+    CreatePipeline(ctx.shadowMapPackedPipeline, {
+        .point = vkw::PipelinePoint::Graphics,
+        .stages = {
+            {.stage = vkw::ShaderStage::Vertex, .path = "shadowMapPacked.vert"},
+            {.stage = vkw::ShaderStage::Geometry, .path = "shadowMap.geom"},
+            {.stage = vkw::ShaderStage::Fragment, .path = "shadowMap.frag"},
+        },
+        .name = "ShadowMap Packed Pipeline",
+        .vertexAttributes = {vkw::Format::RGBA16_snorm, vkw::Format::RGBA16_snorm, vkw::Format::RG16_sfloat},
+        .colorFormats = { },
+        .useDepth = true,
+        .depthFormat = { vkw::Format::D32_sfloat },
+        .cullFront = true,
+    });
     CreatePipeline(ctx.composePipeline, {
         .point = vkw::PipelinePoint::Graphics,
         .stages = {
@@ -261,6 +392,24 @@ void BeginOpaquePass() {
     vkw::CmdBindPipeline(ctx.opaquePipeline);
 }
 
+void DrawOpaqueModels(GPUScene& gpuScene, Ref<SceneAsset>& scene, Ref<CameraNode>& camera) {
+    OpaqueConstants constants;
+    constants.sceneBufferIndex = gpuScene.GetSceneBuffer();
+    constants.modelBufferIndex = gpuScene.GetModelsBuffer();
+
+    CullView view;
+    glm::mat4 cameraView = camera->GetView();
+    SetFrustumPlanes(view, camera->GetProjJittered() * cameraView);
+    glm::mat4 inverseView = glm::inverse(cameraView);
+    view.eye = inverseView[3];
+    view.direction = -glm::normalize(glm::vec3(inverseView[2]));
+    view.orthographic = camera->cameraType == CameraNode::CameraType::Orthographic;
+    view.useCone = true;
+    DrawCulledModels(gpuScene, view, scene->clusterCulling, false, false, constants);
+    vkw::CmdBindPipeline(ctx.opaquePackedPipeline);
+    DrawCulledModels(gpuScene, view, scene->clusterCulling, false, true, constants);
+}
+
 void EndPass() {
     vkw::CmdEndRendering();
 }
@@ -277,15 +426,24 @@ void ShadowMapPass(Ref<LightNode>& light, Ref<SceneAsset>& scene, GPUScene& gpuS
 
     uint32_t layers = light->lightType == LightNode::LightType::Point ? 6u : 1u;
 
+    // the shadow pipeline culls front faces, so clusters fully facing the light can be skipped
+    CullView view;
+    view.eye = light->GetWorldPosition();
+    if (light->lightType == LightNode::LightType::Point) {
+        view.maxDistance = light->shadowMapFar;
+    } else {
+        SetFrustumPlanes(view, shadowMap.viewProj);
+        view.direction = -glm::normalize(light->GetWorldFront());
+        view.orthographic = true;
+        view.useCone = true;
+        view.coneSign = -1.0f;
+    }
+
     vkw::CmdBeginRendering({}, {img}, layers);
     vkw::CmdBindPipeline(ctx.shadowMapPipeline);
-    vkw::CmdPushConstants(&constants, sizeof(constants));
-    auto& allModels = gpuScene.GetMeshModels();
-    for (GPUModel& model : allModels) {
-        constants.modelID = model.modelRID;
-        vkw::CmdPushConstants(&constants, sizeof(constants));
-        vkw::CmdDrawMesh(model.mesh.vertexBuffer, model.mesh.indexBuffer, model.mesh.indexCount);
-    }
+    DrawCulledModels(gpuScene, view, scene->clusterCulling, true, false, constants);
+    vkw::CmdBindPipeline(ctx.shadowMapPackedPipeline);
+    DrawCulledModels(gpuScene, view, scene->clusterCulling, true, true, constants);
     vkw::CmdEndRendering();
     vkw::CmdBarrier(img, vkw::Layout::DepthRead);
     shadowMap.readable = true;
@@ -9,6 +9,7 @@ struct Image;
 }
 
 struct LightNode;
+struct CameraNode;
 struct SceneAsset;
 struct GPUScene;
 
@@ -47,6 +48,7 @@ void LightPass(LightConstants constants);
 void ComposePass(bool separatePass, Output output, Ref<SceneAsset>& scene);
 void LineRenderingPass(GPUScene& gpuScene);
 void BeginOpaquePass();
+void DrawOpaqueModels(GPUScene& gpuScene, Ref<SceneAsset>& scene, Ref<CameraNode>& camera);
 void EndPass();
 void PostProcessingPass(GPUScene& gpuScene);
 void TAAPass(GPUScene& gpuScene, Ref<SceneAsset>& scene);
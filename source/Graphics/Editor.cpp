@@ -3,6 +3,7 @@
 
 #include "GPUScene.hpp"
 #include "AssetManager.hpp"
+#include "OcclusionBaking.hpp"
 #include "VulkanWrapper.h"
 #include "Window.hpp"
 #include "DebugDraw.h"
@@ -275,7 +276,7 @@ void Editor::DemoPanel() {
     ImGui::ShowDemoWindow();
 }
 
-void Editor::ScenePanel(Ref<SceneAsset>& scene) {
+void Editor::ScenePanel(AssetManager& assetManager, Ref<SceneAsset>& scene) {
     if (ImGui::Begin("Scene")) {
         ImGui::Text("Name: %s", scene->name.c_str());
         ImGui::Text("Add");
@@ -328,6 +329,11 @@ void Editor::ScenePanel(Ref<SceneAsset>& scene) {
             }
             ImGui::DragFloat("Min##AO", &scene->aoMin, 0.01f, 0.000f, 10.0f);
             ImGui::DragFloat("Max##AO", &scene->aoMax, 0.1f, 0.000f, 1000.0f);
+            // static nodes use the baked values instead of tracing, bake again after moving them
+            ImGui::DragInt("Bake Samples##AO", &scene->aoBakeSamples, 1, 1, 4096);
+            if (ImGui::Button("Bake Static##AO")) {
+                OcclusionBaking::Bake(assetManager, scene, OcclusionBaking::SceneSettings(*scene));
+            }
 
             ImGui::SeparatorText("Lights");
             ImGui::DragInt("Samples##lights", (int*)&scene->lightSamples, 1, 0, 256);
@@ -347,6 +353,17 @@ void Editor::ScenePanel(Ref<SceneAsset>& scene) {
             ImGui::Checkbox("Enable##TAA", &scene->taaEnabled);
             ImGui::Checkbox("Reconstruction##TAA", &scene->taaReconstruct);
             ImGui::Checkbox("Jitter##TAA", &scene->mainCamera->useJitter);
+
+            ImGui::SeparatorText("Culling");
+            ImGui::Checkbox("Clusters##Culling", &scene->clusterCulling);
+
+            ImGui::SeparatorText("Level of Detail");
+            ImGui::DragFloat("Pixel Error##LOD", &scene->lodPixelError, 0.05f, 0.0f, 64.0f);
+            ImGui::DragInt("Shadow Bias##LOD", &scene->shadowLodBias, 0.05f, 0, 8);
+
+            ImGui::SeparatorText("Static Batching");
+            ImGui::Checkbox("Enable##Batching", &scene->staticBatching);
+            ImGui::DragFloat("Cell Size##Batching", &scene->batchCellSize, 0.5f, 1.0f, 1000.0f);
         }
         // todo: scene camera prameters, speed, etc
     }
@@ -431,6 +448,7 @@ void EditorImpl::InspectLightNode(AssetManager& manager, Ref<LightNode> node, GP
 }
 
 void EditorImpl::InspectMeshNode(AssetManager& manager, Ref<MeshNode> node) {
+    ImGui::Checkbox("Static", &node->isStatic);
     std::string preview = node->mesh ? node->mesh->name : "UNSELECTED";
     if (ImGui::BeginCombo("Mesh", preview.c_str())) {
         for (const auto& mesh : manager.GetAll<MeshAsset>(ObjectType::MeshAsset)) {
@@ -482,6 +500,27 @@ void Editor::AssetsPanel(AssetManager& manager) {
         return;
     }
 
+    float importProgress = 0.0f;
+    u32 importFiles = 0;
+    if (manager.GetImportProgress(importProgress, importFiles)) {
+        std::string overlay = "Importing " + std::to_string(importFiles) + (importFiles == 1 ? " file" : " files");
+        ImGui::ProgressBar(importProgress, ImVec2(-80.0f, 0.0f), overlay.c_str());
+        ImGui::SameLine();
+        if (ImGui::Button("Cancel##Import", ImVec2(-1.0f, 0.0f))) {
+            manager.CancelImports();
+        }
+    }
+
+    // gpu resources of the collected assets are released by the next periodic pass
+    if (ImGui::Button("Collect Unused Assets", ImVec2(-1.0f, 0.0f))) {
+        manager.CollectGarbage();
+    }
+    // data already evicted stays in the .luzbin until something needs it
+    bool evictUploaded = manager.residency == AssetManager::Residency::EvictUploaded;
+    if (ImGui::Checkbox("Evict Uploaded Data", &evictUploaded)) {
+        manager.residency = evictUploaded ? AssetManager::Residency::EvictUploaded : AssetManager::Residency::KeepResident;
+    }
+
     if (ImGui::CollapsingHeader(LUZ_PROJECT_ICON " Projects", ImGuiTreeNodeFlags_DefaultOpen)) {
         std::filesystem::path projectsPath = "assets";
         for (const auto& entry : std::filesystem::directory_iterator(projectsPath)) {
@@ -23,7 +23,7 @@ struct Editor {
 
     void InspectorPanel(AssetManager& assetManager, const Ref<struct CameraNode>& camera, GPUScene& gpuScene);
     void DemoPanel();
-    void ScenePanel(Ref<SceneAsset>& scene);
+    void ScenePanel(AssetManager& assetManager, Ref<SceneAsset>& scene);
     void AssetsPanel(AssetManager& assetManager);
     void ProfilerPanel();
     void ProfilerPopup();
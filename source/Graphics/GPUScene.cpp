@@ -2,8 +2,11 @@
 #include "GPUScene.hpp"
 #include "LuzCommon.h"
 #include "AssetIO.hpp"
+#include "MeshProcessing.hpp"
 #include "DebugDraw.h"
 
+#include <unordered_set>
+
 struct GPUSceneImpl {
     vkw::Buffer sceneBuffer;
     vkw::Buffer modelsBuffer;
@@ -27,6 +30,7 @@ struct GPUSceneImpl {
         .normalMap = -1,
         .emissionMap = -1,
         .metallicRoughnessMap = -1,
+        .occlusionBuffer = -1,
     };
 
     std::vector<GPUModel> meshModels;
@@ -35,6 +39,11 @@ struct GPUSceneImpl {
     std::unordered_map<UUID, GPUMesh> meshes;
     std::unordered_map<UUID, GPUTexture> textures;
 
+    std::vector<StaticBatching::Batch> batches;
+    // per mesh node of the current frame, set when a batch draws it
+    std::vector<u8> batchedNodes;
+    u64 batchSignature = 0;
+
     vkw::Image blueNoise;
     vkw::Image font;
 };
@@ -108,48 +117,111 @@ void GPUScene::Destroy() {
 void GPUScene::AddMesh(const Ref<MeshAsset>& asset) {
     GPUMesh& mesh = impl->meshes[asset->uuid];
     mesh.vertexCount = asset->vertices.size();
-    mesh.indexCount = asset->indices.size();
+    // draws without a lod and the BLAS only use the full detail level
+    mesh.indexCount = asset->lods.empty() ? asset->indices.size() : asset->lods[0].indexCount;
+    mesh.meshlets = std::make_shared<std::vector<MeshAsset::Meshlet>>(asset->meshlets);
+    mesh.lods = std::make_shared<std::vector<MeshAsset::Lod>>(asset->lods);
+    mesh.center = asset->sphereCenter;
+    mesh.radius = asset->sphereRadius;
+    std::vector<MeshAsset::PackedVertex> packedVertices;
+    mesh.packed = asset->packedVertices;
+    if (mesh.packed) {
+        glm::vec3 offset;
+        float scale;
+        MeshProcessing::PackVertices(*asset, packedVertices, offset, scale);
+        mesh.dequantize = glm::translate(glm::mat4(1), offset) * glm::scale(glm::mat4(1), glm::vec3(scale));
+    }
+    u32 vertexStride = mesh.packed ? sizeof(MeshAsset::PackedVertex) : sizeof(MeshAsset::MeshVertex);
     mesh.vertexBuffer = vkw::CreateBuffer(
-        sizeof(MeshAsset::MeshVertex) * asset->vertices.size(),
+        vertexStride * asset->vertices.size(),
         vkw::BufferUsage::Vertex | vkw::BufferUsage::AccelerationStructureInput | vkw::BufferUsage::Storage,
         vkw::Memory::GPU,
         ("VertexBuffer#" + std::to_string(asset->uuid))
     );
+    std::vector<u16> indices16;
+    if (asset->vertices.size() <= MeshAsset::MaxVertices16) {
+        mesh.indexType = vkw::IndexType::UInt16;
+        indices16.assign(asset->indices.begin(), asset->indices.end());
+    }
+    u32 indexSize = mesh.indexType == vkw::IndexType::UInt16 ? sizeof(u16) : sizeof(u32);
     mesh.indexBuffer = vkw::CreateBuffer(
-        sizeof(uint32_t) * asset->indices.size(),
+        indexSize * asset->indices.size(),
         vkw::BufferUsage::Index | vkw::BufferUsage::AccelerationStructureInput | vkw::BufferUsage::Storage,
         vkw::Memory::GPU,
         ("IndexBuffer#" + std::to_string(asset->uuid))
     );
+    // the shaders read the bytes as uints, the padding is unoccluded
+    std::vector<u8> occlusion;
+    mesh.occlusionBuffer = {};
+    if (!asset->occlusion.empty() && asset->occlusion.size() == asset->vertices.size()) {
+        occlusion = asset->occlusion;
+        occlusion.resize((occlusion.size() + 3) / 4 * 4, 255);
+        mesh.occlusionBuffer = vkw::CreateBuffer(
+            u32(occlusion.size()),
+            vkw::BufferUsage::Storage | vkw::BufferUsage::TransferDst,
+            vkw::Memory::GPU,
+            ("OcclusionBuffer#" + std::to_string(asset->uuid))
+        );
+    }
+    // the BLAS of a packed mesh lives in quantized space, its instances apply the dequantization
     mesh.blas = vkw::CreateBLAS ({
         .vertexBuffer = mesh.vertexBuffer,
         .indexBuffer = mesh.indexBuffer,
         .vertexCount = mesh.vertexCount,
         .indexCount = mesh.indexCount,
-        .vertexStride = sizeof(MeshAsset::MeshVertex),
+        .vertexStride = vertexStride,
+        .vertexFormat = mesh.packed ? vkw::Format::RGBA16_snorm : vkw::Format::RGB32_sfloat,
+        .indexType = mesh.indexType,
         .name = "BLAS#" + std::to_string(asset->uuid)
     });;
     vkw::BeginCommandBuffer(vkw::Queue::Graphics);
-    vkw::CmdCopy(mesh.vertexBuffer, asset->vertices.data(), mesh.vertexBuffer.size);
-    vkw::CmdCopy(mesh.indexBuffer, asset->indices.data(), mesh.indexBuffer.size);
+    if (mesh.packed) {
+        vkw::CmdCopy(mesh.vertexBuffer, packedVertices.data(), mesh.vertexBuffer.size);
+    } else {
+        vkw::CmdCopy(mesh.vertexBuffer, asset->vertices.data(), mesh.vertexBuffer.size);
+    }
+    if (mesh.indexType == vkw::IndexType::UInt16) {
+        vkw::CmdCopy(mesh.indexBuffer, indices16.data(), mesh.indexBuffer.size);
+    } else {
+        vkw::CmdCopy(mesh.indexBuffer, asset->indices.data(), mesh.indexBuffer.size);
+    }
+    if (!occlusion.empty()) {
+        vkw::CmdCopy(mesh.occlusionBuffer, occlusion.data(), u32(occlusion.size()));
+    }
     vkw::CmdBuildBLAS(mesh.blas);
     vkw::EndCommandBuffer();
     vkw::WaitQueue(vkw::Queue::Graphics);
 }
 
+static vkw::Format TextureFormat(TextureAsset::Encoding encoding) {
+    switch (encoding) {
+    case TextureAsset::Encoding::BC1:
+        return vkw::Format::BC1_RGBA_unorm;
+    case TextureAsset::Encoding::BC4:
+        return vkw::Format::BC4_unorm;
+    case TextureAsset::Encoding::BC5:
+        return vkw::Format::BC5_unorm;
+    case TextureAsset::Encoding::BC7:
+        return vkw::Format::BC7_unorm;
+    default:
+        return vkw::Format::RGBA8_unorm;
+    }
+}
+
 void GPUScene::AddTexture(const Ref<TextureAsset>& asset) {
     GPUTexture& texture = impl->textures[asset->uuid];
     ASSERT(asset->channels == 4, "Invalid number of channels");
     texture.image = vkw::CreateImage({
         .width = uint32_t(asset->width),
         .height = uint32_t(asset->height),
-        .format = vkw::Format::RGBA8_unorm,
+        .format = TextureFormat(asset->encoding),
         .usage = vkw::ImageUsage::Sampled | vkw::ImageUsage::TransferDst,
         .name = "Texture " + std::to_string(asset->uuid),
+        .mipLevels = uint32_t(std::max(asset->mipLevels, 1)),
     });
     vkw::BeginCommandBuffer(vkw::Queue::Graphics);
     vkw::CmdBarrier(texture.image, vkw::Layout::TransferDst);
-    vkw::CmdCopy(texture.image, asset->data.data(), asset->width * asset->height * asset->channels);
+    vkw::CmdCopy(texture.image, asset->data.data(), uint32_t(asset->data.size()));
     vkw::CmdBarrier(texture.image, vkw::Layout::ShaderRead);
     vkw::EndCommandBuffer();
     vkw::WaitQueue(vkw::Queue::Graphics);
@@ -159,22 +231,155 @@ void GPUScene::ClearAssets() {
     impl->meshes.clear();
     impl->textures.clear();
     impl->meshModels.clear();
+    impl->batches.clear();
+    impl->batchSignature = 0;
+}
+
+void GPUScene::CollectGarbage(const AssetManager& assets, const Ref<SceneAsset>& scene) {
+    LUZ_PROFILE_NAMED("GPUScene::CollectGarbage");
+    // batch meshes aren't assets, they're released when their batch is rebuilt
+    std::unordered_set<UUID> batchMeshes;
+    for (const StaticBatching::Batch& batch : impl->batches) {
+        batchMeshes.insert(batch.node->mesh->uuid);
+    }
+    std::unordered_set<UUID> lights;
+    for (const Ref<LightNode>& light : scene->GetAll<LightNode>(ObjectType::LightNode)) {
+        lights.insert(light->uuid);
+    }
+    std::vector<UUID> meshes;
+    std::vector<UUID> textures;
+    std::vector<UUID> shadowMaps;
+    for (const auto& [uuid, mesh] : impl->meshes) {
+        if (!batchMeshes.count(uuid) && !assets.Get(uuid)) {
+            meshes.push_back(uuid);
+        }
+    }
+    for (const auto& [uuid, texture] : impl->textures) {
+        if (!assets.Get(uuid)) {
+            textures.push_back(uuid);
+        }
+    }
+    for (const auto& [uuid, shadowMap] : impl->shadowMaps) {
+        if (!lights.count(uuid)) {
+            shadowMaps.push_back(uuid);
+        }
+    }
+    if (meshes.empty() && textures.empty() && shadowMaps.empty()) {
+        return;
+    }
+    // resources are destroyed as soon as their last handle goes away, frames in flight may still read them
+    vkw::WaitIdle();
+    impl->meshModels.clear();
+    for (UUID uuid : meshes) {
+        impl->meshes.erase(uuid);
+    }
+    for (UUID uuid : textures) {
+        impl->textures.erase(uuid);
+    }
+    for (UUID uuid : shadowMaps) {
+        impl->shadowMaps.erase(uuid);
+    }
+    LOG_INFO("Released {} meshes, {} textures and {} shadow maps from the gpu", meshes.size(), textures.size(), shadowMaps.size());
 }
 
-void GPUScene::AddAssets(const AssetManager& assets) {
+void GPUScene::AddAssets(AssetManager& assets) {
+    // uploads wait for the queue, so the cpu copies can be evicted right after
+    size_t evictedBytes = 0;
     const auto& meshes = assets.GetAll<MeshAsset>(ObjectType::MeshAsset);
     for (auto& mesh : meshes) {
         if (mesh->gpuDirty) {
-            AddMesh(mesh);
+            // a modified mesh replaces buffers frames in flight may still read, and batches merged from it
+            if (impl->meshes.count(mesh->uuid)) {
+                vkw::WaitIdle();
+                impl->batchSignature = 0;
+            }
+            if (assets.MakeResident(mesh)) {
+                AddMesh(mesh);
+            }
             mesh->gpuDirty = false;
         }
+        evictedBytes += assets.Evict(mesh);
     }
     const auto& textures = assets.GetAll<TextureAsset>(ObjectType::TextureAsset);
     for (auto& texture : textures) {
         if (texture->gpuDirty) {
-            AddTexture(texture);
+            if (assets.MakeResident(texture)) {
+                AddTexture(texture);
+            }
             texture->gpuDirty = false;
         }
+        evictedBytes += assets.Evict(texture);
+    }
+    if (evictedBytes) {
+        LOG_INFO("Evicted {:.1f} MB of uploaded mesh and texture data", evictedBytes / (1024.0 * 1024.0));
+    }
+}
+
+// coarsest level whose error stays under lodPixelError once projected on the screen
+static u32 SelectLod(const GPUMesh& mesh, const glm::mat4& modelMat, const Ref<SceneAsset>& scene, const Ref<CameraNode>& camera, const glm::vec3& eye) {
+    if (!mesh.lods || mesh.lods->size() <= 1) {
+        return 0;
+    }
+    float scale = glm::max(glm::length(modelMat[0]), glm::max(glm::length(modelMat[1]), glm::length(modelMat[2])));
+    glm::vec3 center = modelMat * glm::vec4(mesh.center, 1.0f);
+    float pixelsPerUnit = glm::abs(camera->GetProj()[1][1]) * 0.5f * camera->extent.y;
+    if (camera->cameraType == CameraNode::CameraType::Perspective) {
+        float distance = glm::distance(center, eye) - mesh.radius * scale;
+        pixelsPerUnit /= glm::max(distance, camera->nearDistance);
+    }
+    u32 lod = 0;
+    for (u32 i = 1; i < mesh.lods->size(); i++) {
+        if ((*mesh.lods)[i].error * scale * pixelsPerUnit > scene->lodPixelError) {
+            break;
+        }
+        lod = i;
+    }
+    return lod;
+}
+
+void GPUScene::UpdateStaticBatches(const Ref<SceneAsset>& scene, const std::vector<Ref<MeshNode>>& nodes, const std::vector<glm::mat4>& transforms) {
+    LUZ_PROFILE_NAMED("UpdateStaticBatches");
+    u64 signature = scene->staticBatching ? StaticBatching::Signature(nodes, scene->batchCellSize) : 0;
+    std::vector<UUID> oldMeshes;
+    std::vector<Ref<MeshAsset>> newMeshes;
+    if (signature != impl->batchSignature) {
+        auto start = std::chrono::high_resolution_clock::now();
+        for (const StaticBatching::Batch& batch : impl->batches) {
+            oldMeshes.push_back(batch.node->mesh->uuid);
+        }
+        impl->batches = scene->staticBatching ? StaticBatching::Build(nodes, transforms, scene->batchCellSize) : std::vector<StaticBatching::Batch>();
+        impl->batchSignature = signature;
+        size_t sources = 0;
+        for (const StaticBatching::Batch& batch : impl->batches) {
+            newMeshes.push_back(batch.node->mesh);
+            sources += batch.sources.size();
+        }
+        if (scene->staticBatching) {
+            float milliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+            LOG_INFO("Merged {} static nodes into {} batches in {:.1f} ms", sources, impl->batches.size(), milliseconds);
+        }
+    } else {
+        // edited proxies are merged again with their new transforms
+        for (StaticBatching::Batch& batch : impl->batches) {
+            if (StaticBatching::IsStale(batch, transforms)) {
+                oldMeshes.push_back(batch.node->mesh->uuid);
+                StaticBatching::Merge(batch, nodes, transforms);
+                newMeshes.push_back(batch.node->mesh);
+            }
+        }
+    }
+    // AddMesh waits for the queue, so the old buffers are no longer in use once they're erased
+    for (const Ref<MeshAsset>& mesh : newMeshes) {
+        AddMesh(mesh);
+    }
+    for (UUID uuid : oldMeshes) {
+        impl->meshes.erase(uuid);
+    }
+    impl->batchedNodes.assign(nodes.size(), 0);
+    for (const StaticBatching::Batch& batch : impl->batches) {
+        for (u32 source : batch.sources) {
+            impl->batchedNodes[source] = 1;
+        }
     }
 }
 
@@ -184,12 +389,38 @@ void GPUScene::UpdateResources(const Ref<SceneAsset>& scene, const Ref<CameraNod
     scene->GetAll<MeshNode>(ObjectType::MeshNode, meshNodes);
     impl->modelsBlock.clear();
     impl->meshModels.clear();
-    for (const auto& node : meshNodes) {
-        impl->meshModels.push_back(GPUModel{
+    glm::vec3 eye = glm::inverse(camera->GetView())[3];
+    std::vector<glm::mat4> transforms(meshNodes.size());
+    for (size_t i = 0; i < meshNodes.size(); i++) {
+        transforms[i] = meshNodes[i]->GetWorldTransform();
+    }
+    UpdateStaticBatches(scene, meshNodes, transforms);
+    std::vector<Ref<MeshNode>> drawnNodes;
+    std::vector<glm::mat4> drawnTransforms;
+    for (size_t i = 0; i < meshNodes.size(); i++) {
+        // batched proxies only refresh their bounds, the batch draws them
+        meshNodes[i]->UpdateWorldBounds(transforms[i]);
+        if (!impl->batchedNodes[i]) {
+            drawnNodes.push_back(meshNodes[i]);
+            drawnTransforms.push_back(transforms[i]);
+        }
+    }
+    for (const StaticBatching::Batch& batch : impl->batches) {
+        drawnNodes.push_back(batch.node);
+        drawnTransforms.push_back(glm::mat4(1));
+    }
+    for (size_t i = 0; i < drawnNodes.size(); i++) {
+        const Ref<MeshNode>& node = drawnNodes[i];
+        GPUModel& model = impl->meshModels.emplace_back(GPUModel{
             .mesh = impl->meshes[node->mesh->uuid],
             .modelRID = uint32_t(impl->modelsBlock.size()),
             .node = node,
+            .modelMat = drawnTransforms[i],
             });
+        model.lod = SelectLod(model.mesh, model.modelMat, scene, camera, eye);
+        if (model.mesh.lods && !model.mesh.lods->empty()) {
+            model.shadowLod = glm::min(model.lod + u32(glm::max(scene->shadowLodBias, 0)), u32(model.mesh.lods->size()) - 1);
+        }
         ModelBlock& block = impl->modelsBlock.emplace_back();
         Ref<MaterialAsset> material = node->material;
         block = impl->defaultModelBlock;
@@ -213,10 +444,8 @@ void GPUScene::UpdateResources(const Ref<SceneAsset>& scene, const Ref<CameraNod
         }
         block.vertexBuffer = impl->meshes[node->mesh->uuid].vertexBuffer.RID();
         block.indexBuffer = impl->meshes[node->mesh->uuid].indexBuffer.RID();
-        block.modelMat = node->GetWorldTransform();
-
-        auto pos = node->GetWorldPosition();
-        auto size = node->scale;
+        block.occlusionBuffer = model.mesh.occlusionBuffer.resource ? int(model.mesh.occlusionBuffer.RID()) : -1;
+        block.modelMat = model.modelMat * model.mesh.dequantize;
     }
 
     SceneBlock& s = impl->sceneBlock;
@@ -326,6 +555,7 @@ void GPUScene::UpdateResources(const Ref<SceneAsset>& scene, const Ref<CameraNod
         }
 
         impl->shadowMaps[light->uuid].lightIndex = s.numLights - 1;
+        impl->shadowMaps[light->uuid].viewProj = block.viewProj[0];
         block.shadowMap = impl->shadowMaps[light->uuid].img.RID();
     }
     s.ambientLightColor = scene->ambientLightColor;
@@ -357,7 +587,7 @@ void GPUScene::UpdateResourcesGPU() {
             GPUModel& model = impl->meshModels[i];
             vkwInstances[i] = vkw::BLASInstance{
                 .blas = model.mesh.blas,
-                .modelMat = model.node->GetWorldTransform(),
+                .modelMat = model.modelMat * model.mesh.dequantize,
                 .customIndex = model.modelRID,
             };
         }
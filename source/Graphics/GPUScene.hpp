@@ -3,6 +3,7 @@
 #include "Base.hpp"
 #include "VulkanWrapper.h"
 #include "AssetManager.hpp"
+#include "StaticBatching.hpp"
 
 #include <unordered_map>
 
@@ -12,6 +13,7 @@ struct ShadowMapData {
     vkw::Image img;
     bool readable = false;
     int lightIndex = -1;
+    glm::mat4 viewProj = glm::mat4(1);
 };
 
 struct GPUMesh {
@@ -19,7 +21,18 @@ struct GPUMesh {
     vkw::Buffer indexBuffer;
     u32 vertexCount;
     u32 indexCount;
+    vkw::IndexType indexType = vkw::IndexType::UInt32;
     vkw::BLAS blas;
+    // baked ambient occlusion, one byte per vertex read by the vertex shaders. empty unless the mesh was baked
+    vkw::Buffer occlusionBuffer;
+    // shared so copying a GPUMesh into each GPUModel stays cheap
+    Ref<std::vector<MeshAsset::Meshlet>> meshlets;
+    Ref<std::vector<MeshAsset::Lod>> lods;
+    glm::vec3 center;
+    float radius;
+    bool packed = false;
+    // maps packed snorm positions to object space
+    glm::mat4 dequantize = glm::mat4(1);
 };
 
 struct GPUTexture {
@@ -30,6 +43,9 @@ struct GPUModel {
     GPUMesh mesh;
     uint32_t modelRID;
     Ref<MeshNode> node;
+    glm::mat4 modelMat;
+    u32 lod = 0;
+    u32 shadowLod = 0;
 };
 
 struct GPUScene {
@@ -41,8 +57,11 @@ struct GPUScene {
 
     void AddMesh(const Ref<MeshAsset>& asset);
     void AddTexture(const Ref<TextureAsset>& asset);
-    void AddAssets(const AssetManager& assets);
+    void AddAssets(AssetManager& assets);
     void ClearAssets();
+    // releases the buffers, blases and images of assets no longer in the manager and the shadow maps of
+    // lights no longer in the scene, waits for the gpu when anything is released
+    void CollectGarbage(const AssetManager& assets, const Ref<SceneAsset>& scene);
 
     bool AnyVolumetricLight();
 
@@ -59,5 +78,8 @@ struct GPUScene {
     vkw::Buffer GetLinesBuffer();
 
 private:
+    // rebuilds every batch when batchable nodes change and re-merges batches whose sources moved
+    void UpdateStaticBatches(const Ref<SceneAsset>& scene, const std::vector<Ref<MeshNode>>& nodes, const std::vector<glm::mat4>& transforms);
+
     GPUSceneImpl* impl;
 };
\ No newline at end of file
@@ -497,7 +497,7 @@ Image CreateImage(const ImageDesc& desc) {
     imageInfo.extent.width = desc.width;
     imageInfo.extent.height = desc.height;
     imageInfo.extent.depth = 1;
-    imageInfo.mipLevels = 1;
+    imageInfo.mipLevels = desc.mipLevels;
     imageInfo.arrayLayers = desc.layers;
     imageInfo.format = (VkFormat)desc.format;
     // tiling defines how the texels lay in memory
@@ -539,7 +539,7 @@ Image CreateImage(const ImageDesc& desc) {
     viewInfo.format = (VkFormat)desc.format;
     viewInfo.subresourceRange.aspectMask = (VkImageAspectFlags)aspect;
     viewInfo.subresourceRange.baseMipLevel = 0;
-    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.levelCount = desc.mipLevels;
     viewInfo.subresourceRange.baseArrayLayer = 0;
     viewInfo.subresourceRange.layerCount = desc.layers;
 
@@ -566,6 +566,7 @@ Image CreateImage(const ImageDesc& desc) {
         .layout = Layout::Undefined,
         .aspect = aspect,
         .layers = desc.layers,
+        .mipLevels = desc.mipLevels,
     };
 
     if (desc.usage & ImageUsage::Sampled || desc.usage & ImageUsage::Storage) {
@@ -763,12 +764,12 @@ BLAS CreateBLAS(const BLASDesc& desc) {
     // Describe buffer as array of VertexObj.
     VkAccelerationStructureGeometryTrianglesDataKHR triangles = {};
     triangles.sType = VK_STRUCTURE_TYPE_ACCELERATION_STRUCTURE_GEOMETRY_TRIANGLES_DATA_KHR;
-    triangles.vertexFormat = VK_FORMAT_R32G32B32_SFLOAT;
+    triangles.vertexFormat = (VkFormat)desc.vertexFormat;
     triangles.vertexData.deviceAddress = vertexAddress;
     triangles.vertexStride = desc.vertexStride;
     triangles.maxVertex = desc.vertexCount;
-    // Describe index data (32-bit unsigned int)
-    triangles.indexType = VK_INDEX_TYPE_UINT32;
+    // Describe index data (16 or 32-bit unsigned int)
+    triangles.indexType = (VkIndexType)desc.indexType;
     triangles.indexData.deviceAddress = indexAddress;
     // Indicate identity transform by setting transformData to null device pointer.
     // triangles.transformData = {};
@@ -975,7 +976,11 @@ void Context::CreatePipeline(const PipelineDesc& desc, Pipeline& pipeline) {
             attributeDescs[i].location = i;
             attributeDescs[i].format = (VkFormat)desc.vertexAttributes[i];
             attributeDescs[i].offset = attributeSize;
-            if (desc.vertexAttributes[i] == Format::RG32_sfloat) {
+            if (desc.vertexAttributes[i] == Format::RG16_sfloat) {
+                attributeSize += 2 * sizeof(uint16_t);
+            } else if (desc.vertexAttributes[i] == Format::RGBA16_snorm) {
+                attributeSize += 4 * sizeof(int16_t);
+            } else if (desc.vertexAttributes[i] == Format::RG32_sfloat) {
                 attributeSize += 2 * sizeof(float);
             } else if (desc.vertexAttributes[i] == Format::RGB32_sfloat) {
                 attributeSize += 3 * sizeof(float);
@@ -1246,12 +1251,12 @@ void CmdEndPresent() {
     vkw::CmdBarrier(_ctx.GetCurrentSwapChainImage(), vkw::Layout::Present);
 }
 
-void CmdDrawMesh(Buffer& vertexBuffer, Buffer& indexBuffer, uint32_t indexCount) {
+void CmdDrawMesh(Buffer& vertexBuffer, Buffer& indexBuffer, uint32_t indexCount, uint32_t firstIndex, IndexType indexType) {
     auto& cmd = _ctx.GetCurrentCommandResources();
     VkDeviceSize offsets[] = { 0 };
     vkCmdBindVertexBuffers(cmd.buffer, 0, 1, &vertexBuffer.resource->buffer, offsets);
-    vkCmdBindIndexBuffer(cmd.buffer, indexBuffer.resource->buffer, 0, VK_INDEX_TYPE_UINT32);
-    vkCmdDrawIndexed(cmd.buffer, indexCount, 1, 0, 0, 0);
+    vkCmdBindIndexBuffer(cmd.buffer, indexBuffer.resource->buffer, 0, (VkIndexType)indexType);
+    vkCmdDrawIndexed(cmd.buffer, indexCount, 1, firstIndex, 0, 0);
 }
 
 void CmdDrawLineStrip(const Buffer& pointsBuffer, uint32_t firstPoint, uint32_t pointCount, float thickness) {
@@ -1812,7 +1817,7 @@ void Context::CreateDevice() {
         vkGetDeviceQueue(device, queues[q].family, 0, &queues[q].queue);
     }
 
-    genericSampler = CreateSampler(1.0);
+    genericSampler = CreateSampler(VK_LOD_CLAMP_NONE);
     vkSetDebugUtilsObjectNameEXT = (PFN_vkSetDebugUtilsObjectNameEXT)vkGetDeviceProcAddr(device, "vkSetDebugUtilsObjectNameEXT");
     vkGetAccelerationStructureBuildSizesKHR = (PFN_vkGetAccelerationStructureBuildSizesKHR)vkGetDeviceProcAddr(device, "vkGetAccelerationStructureBuildSizesKHR");
     vkCreateAccelerationStructureKHR = (PFN_vkCreateAccelerationStructureKHR)vkGetDeviceProcAddr(device, "vkCreateAccelerationStructureKHR");
@@ -2366,20 +2371,46 @@ void Context::CmdCopy(Image& dst, void* data, uint32_t size) {
     cmd.stagingOffset += size;
 }
 
+static uint32_t LevelSize(Format format, uint32_t width, uint32_t height) {
+    switch (format) {
+    case Format::RG32_sfloat:
+        return width * height * 8;
+    case Format::RGB32_sfloat:
+        return width * height * 12;
+    case Format::RGBA32_sfloat:
+        return width * height * 16;
+    case Format::BC1_RGBA_unorm:
+    case Format::BC4_unorm:
+        return ((width + 3) / 4) * ((height + 3) / 4) * 8;
+    case Format::BC5_unorm:
+    case Format::BC7_unorm:
+        return ((width + 3) / 4) * ((height + 3) / 4) * 16;
+    default:
+        return width * height * 4;
+    }
+}
+
 void Context::CmdCopy(Image& dst, Buffer& src, uint32_t size, uint32_t srcOffset) {
     CommandResources& cmd = GetCurrentCommandResources();
-    VkBufferImageCopy region{};
-    region.bufferOffset = srcOffset;
-    region.bufferRowLength = 0;
-    region.bufferImageHeight = 0;
     ASSERT(!(dst.aspect & Aspect::Depth || dst.aspect & Aspect::Stencil), "CmdCopy don't support depth/stencil images");
-    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    region.imageSubresource.mipLevel = 0;
-    region.imageSubresource.baseArrayLayer = 0;
-    region.imageSubresource.layerCount = 1;
-    region.imageOffset = { 0, 0, 0 };
-    region.imageExtent = { dst.width, dst.height, 1 };
-    vkCmdCopyBufferToImage(cmd.buffer, src.resource->buffer, dst.resource->image, (VkImageLayout)dst.layout, 1, &region);
+    // levels are tightly packed one after the other
+    std::vector<VkBufferImageCopy> regions(dst.mipLevels);
+    uint32_t offset = srcOffset;
+    for (uint32_t level = 0; level < dst.mipLevels; level++) {
+        VkBufferImageCopy& region = regions[level];
+        region.bufferOffset = offset;
+        region.bufferRowLength = 0;
+        region.bufferImageHeight = 0;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = level;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+        region.imageOffset = { 0, 0, 0 };
+        region.imageExtent = { std::max(1u, dst.width >> level), std::max(1u, dst.height >> level), 1 };
+        offset += LevelSize(dst.format, region.imageExtent.width, region.imageExtent.height);
+    }
+    DEBUG_ASSERT(offset - srcOffset <= size, "Image data smaller than its mip chain");
+    vkCmdCopyBufferToImage(cmd.buffer, src.resource->buffer, dst.resource->image, (VkImageLayout)dst.layout, (uint32_t)regions.size(), regions.data());
 }
 
 void Context::CmdBarrier(Image& img, Layout::ImageLayout layout) {
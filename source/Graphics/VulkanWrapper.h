@@ -53,11 +53,22 @@ using BufferUsageFlags = Flags;
 enum Format {
     RGBA8_unorm = 37,
     BGRA8_unorm = 44,
+    RG16_sfloat = 83,
+    RGBA16_snorm = 92,
     RG32_sfloat = 103,
     RGB32_sfloat = 106,
     RGBA32_sfloat = 109,
     D32_sfloat = 126,
     D24_unorm_S8_uint = 129,
+    BC1_RGBA_unorm = 133,
+    BC4_unorm = 139,
+    BC5_unorm = 141,
+    BC7_unorm = 145,
+};
+
+enum class IndexType {
+    UInt16 = 0,
+    UInt32 = 1,
 };
 
 namespace ImageUsage {
@@ -126,6 +137,7 @@ struct Image {
     Layout::ImageLayout layout;
     AspectFlags aspect;
     uint32_t layers = 1;
+    uint32_t mipLevels = 1;
     uint32_t RID();
     ImTextureID ImGuiRID();
     ImTextureID ImGuiRID(uint32_t layer);
@@ -145,6 +157,7 @@ struct ImageDesc {
     ImageUsageFlags usage;
     std::string name = "";
     uint32_t layers = 1;
+    uint32_t mipLevels = 1;
 };
 
 namespace PipelinePoint {
@@ -205,6 +218,8 @@ struct BLASDesc {
     uint32_t vertexCount;
     uint32_t indexCount;
     uint32_t vertexStride;
+    Format vertexFormat = Format::RGB32_sfloat;
+    IndexType indexType = IndexType::UInt32;
     std::string name;
 };
 
@@ -229,6 +244,7 @@ void GetTimeStamps(std::map<std::string, float>& timeTable);
 
 void CmdCopy(Buffer& dst, void* data, uint32_t size, uint32_t dstOfsset = 0);
 void CmdCopy(Buffer& dst, Buffer& src, uint32_t size, uint32_t dstOffset = 0, uint32_t srcOffset = 0);
+// data holds every mip level after the previous one, level 0 first
 void CmdCopy(Image& dst, void* data, uint32_t size);
 void CmdCopy(Image& dst, Buffer& src, uint32_t size, uint32_t srcOffset = 0);
 void CmdBarrier(Image& img, Layout::ImageLayout layout);
@@ -241,7 +257,7 @@ void CmdBindPipeline(Pipeline& pipeline);
 void CmdPushConstants(void* data, uint32_t size);
 void CmdBuildBLAS(BLAS& blas);
 void CmdBuildTLAS(TLAS& tlas, const std::vector<BLASInstance>& instances);
-void CmdDrawMesh(Buffer& vertexBuffer, Buffer& indexBuffer, uint32_t indexCount);
+void CmdDrawMesh(Buffer& vertexBuffer, Buffer& indexBuffer, uint32_t indexCount, uint32_t firstIndex = 0, IndexType indexType = IndexType::UInt32);
 void CmdDrawLineStrip(const Buffer& pointsBuffer, uint32_t firstPoint, uint32_t pointCount, float thickness = 1.0f);
 void CmdDrawPassThrough();
 void CmdDrawImGui(ImDrawData* data);
@@ -2,6 +2,10 @@
 #include "AssetIO.hpp"
 #include "AssetManager.hpp"
 #include "Log.hpp"
+#include "ThreadPool.hpp"
+#include "MeshProcessing.hpp"
+#include "TextureProcessing.hpp"
+#include "GeometryCodec.hpp"
 
 #define TINYGLTF_IMPLEMENTATION
 #include <tiny_gltf.h>
@@ -15,30 +19,86 @@
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include <stb_image_write.h>
 
+#include <charconv>
+#include <json.hpp>
 #include <ostream>
 
-namespace std {
-    template<> struct hash<MeshAsset::MeshVertex> {
-        size_t operator()(MeshAsset::MeshVertex const& vertex) const {
-            return ((hash<glm::vec3>()(vertex.position) ^ (hash<glm::vec3>()(vertex.normal) << 1)) >> 1) ^
-                (hash<glm::vec2>()(vertex.texCoord) << 1);
-        }
-    };
-}
+#if defined(LUZ_PLATFORM_WINDOWS)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__SSSE3__) || defined(__AVX__)
+#include <tmmintrin.h>
+#define LUZ_SSSE3
+#endif
 
 namespace AssetIO {
 
-UUID ImportSceneGLTF(const std::filesystem::path& path, AssetManager& manager);
-UUID ImportSceneOBJ(const std::filesystem::path& path, AssetManager& manager);
+UUID ImportSceneGLTF(const std::filesystem::path& path, AssetManager& manager, const ImportSettings& settings, ImportProgress* progress, ImportReport& report);
+UUID ImportSceneOBJ(const std::filesystem::path& path, AssetManager& manager, const ImportSettings& settings, ImportProgress* progress, ImportReport& report);
+UUID ImportScenePLY(const std::filesystem::path& path, AssetManager& manager, const ImportSettings& settings, ImportProgress* progress, ImportReport& report);
+
+// counts a finished import step, returns true when the import should stop
+static bool NextStep(ImportProgress* progress) {
+    if (!progress) {
+        return false;
+    }
+    progress->steps++;
+    return progress->cancel;
+}
+
+// adds the wall time of its scope to a stage of the report, importers running stages in sequence move
+// one timer along with Next and pause it with Stop around stages timed elsewhere
+struct StageTimer {
+    ImportReport& report;
+    ImportReport::Stage stage;
+    std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
+
+    void Next(ImportReport::Stage next) {
+        Stop();
+        stage = next;
+        start = std::chrono::high_resolution_clock::now();
+    }
+
+    void Stop() {
+        if (stage != ImportReport::StageCount) {
+            report.stageMilliseconds[stage] += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+        }
+        stage = ImportReport::StageCount;
+    }
+
+    ~StageTimer() {
+        Stop();
+    }
+};
+
+static u64 FileSize(const std::filesystem::path& path) {
+    std::error_code error;
+    u64 size = std::filesystem::file_size(path, error);
+    return error ? 0 : size;
+}
+
+// dds and ktx2 files hold a payload that is uploaded as is, without decoding or processing
+static bool IsTextureContainer(const std::filesystem::path& path) {
+    const std::string ext = path.extension().string();
+    return ext == ".dds" || ext == ".ktx2";
+}
 
 bool IsTexture(const std::filesystem::path& path) {
     const std::string ext = path.extension().string();
-    return ext == ".jpg" || ext == ".png" || ext == ".jpeg" || ext == ".tga" || ext == ".bmp";
+    return ext == ".jpg" || ext == ".png" || ext == ".jpeg" || ext == ".tga" || ext == ".bmp" || IsTextureContainer(path);
 }
 
 bool IsScene(const std::filesystem::path& path){
     const std::string ext = path.extension().string();
-    return ext == ".obj" || ext == ".gltf" || ext == ".glb";
+    return ext == ".obj" || ext == ".gltf" || ext == ".glb" || ext == ".ply";
 }
 
 std::string ReadFile(const std::filesystem::path& path) {
@@ -49,12 +109,68 @@ std::string ReadFile(const std::filesystem::path& path) {
 }
 
 std::vector<u8> ReadFileBytes(const std::filesystem::path& path) {
-    std::ifstream input(path, std::ios::binary);
-    std::vector<u8> bytes((std::istreambuf_iterator<char>(input)), (std::istreambuf_iterator<char>()));
-    input.close();
+    std::ifstream input(path, std::ios::binary | std::ios::ate);
+    std::vector<u8> bytes;
+    if (input.is_open()) {
+        bytes.resize((size_t)input.tellg());
+        input.seekg(0);
+        input.read((char*)bytes.data(), bytes.size());
+    }
     return bytes;
 }
 
+MappedFile::~MappedFile() {
+    if (data) {
+#if defined(LUZ_PLATFORM_WINDOWS)
+        UnmapViewOfFile(data);
+#else
+        munmap((void*)data, size);
+#endif
+    }
+}
+
+Ref<MappedFile> MapFile(const std::filesystem::path& path) {
+    Ref<MappedFile> file = std::make_shared<MappedFile>();
+#if defined(LUZ_PLATFORM_WINDOWS)
+    HANDLE handle = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return nullptr;
+    }
+    LARGE_INTEGER size;
+    GetFileSizeEx(handle, &size);
+    file->size = size.QuadPart;
+    if (file->size > 0) {
+        HANDLE mapping = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping) {
+            file->data = (const u8*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(handle);
+#else
+    int fd = open(path.string().c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat info;
+    fstat(fd, &info);
+    file->size = info.st_size;
+    if (file->size > 0) {
+        void* ptr = mmap(nullptr, file->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (ptr != MAP_FAILED) {
+            madvise(ptr, file->size, MADV_SEQUENTIAL);
+            file->data = (const u8*)ptr;
+        }
+    }
+    close(fd);
+#endif
+    if (file->size > 0 && !file->data) {
+        LOG_ERROR("Failed to map file {}", path.string());
+        return nullptr;
+    }
+    return file;
+}
+
 void WriteFileBytes(const std::filesystem::path& path, const std::vector<u8>& content) {
     std::ofstream file(path, std::ofstream::binary);
     if (file.is_open()) {
@@ -71,15 +187,108 @@ void WriteFile(const std::filesystem::path& path, const std::string& content) {
     }
 }
 
-UUID Import(const std::filesystem::path& path, AssetManager& assets) {
-    TimeScope t("AssetIO::Import(" + path.string() + ")", true);
-    const std::string ext = path.extension().string();
+u64 ImportKey(const std::filesystem::path& path, const ImportSettings& settings) {
+    static_assert(std::has_unique_object_representations_v<ImportSettings>, "ImportSettings is hashed as bytes");
+    Ref<MappedFile> file = MapFile(path);
+    if (!file) {
+        return 0;
+    }
+    u64 settingsHash = Hash64(&settings, sizeof(settings));
+    return Hash64(file->data, file->size, settingsHash);
+}
+
+UUID Import(const std::filesystem::path& path, AssetManager& assets, const ImportSettings& settings, ImportProgress* progress, ImportReport* report) {
+    ImportReport localReport;
+    ImportReport& r = report ? *report : localReport;
+    r = {};
+    r.file = path.string();
+    size_t assetCount = assets.AssetCount();
+    auto start = std::chrono::high_resolution_clock::now();
+    UUID uuid = 0;
     if (IsTexture(path)) {
-        return ImportTexture(path, assets);
+        uuid = ImportTexture(path, assets, &r);
     } else if (IsScene(path)) {
-        return ImportScene(path, assets);
+        uuid = ImportScene(path, assets, settings, progress, &r);
     }
-    return 0;
+    if (progress) {
+        progress->steps = ImportSteps;
+    }
+    r.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    r.assets = assets.AssetCount() - assetCount;
+    r.failed = uuid == 0;
+    LOG_INFO("Import report {}", r.ToJson());
+    return uuid;
+}
+
+const char* ImportReport::StageName(Stage stage) {
+    static constexpr const char* names[] = { "parse", "textureDecode", "textureProcess", "geometry", "tangents", "optimize", "lods", "meshlets", "scene" };
+    static_assert(std::size(names) == StageCount);
+    return names[stage];
+}
+
+ImportReport& ImportReport::operator+=(const ImportReport& rhs) {
+    failed |= rhs.failed;
+    milliseconds += rhs.milliseconds;
+    for (u32 i = 0; i < StageCount; i++) {
+        stageMilliseconds[i] += rhs.stageMilliseconds[i];
+    }
+    bytesRead += rhs.bytesRead;
+    textures += rhs.textures;
+    textureBytesRead += rhs.textureBytesRead;
+    textureBytesDecoded += rhs.textureBytesDecoded;
+    meshes += rhs.meshes;
+    verticesRead += rhs.verticesRead;
+    verticesUnique += rhs.verticesUnique;
+    verticesOptimized += rhs.verticesOptimized;
+    triangles += rhs.triangles;
+    lods += rhs.lods;
+    meshlets += rhs.meshlets;
+    assets += rhs.assets;
+    return *this;
+}
+
+static nlohmann::ordered_json ReportToJson(const ImportReport& report) {
+    nlohmann::ordered_json j;
+    j["file"] = report.file;
+    j["failed"] = report.failed;
+    j["milliseconds"] = report.milliseconds;
+    nlohmann::ordered_json& stages = j["stageMilliseconds"] = nlohmann::ordered_json::object();
+    for (u32 i = 0; i < ImportReport::StageCount; i++) {
+        stages[ImportReport::StageName(ImportReport::Stage(i))] = report.stageMilliseconds[i];
+    }
+    j["bytesRead"] = report.bytesRead;
+    j["textures"] = report.textures;
+    j["textureBytesRead"] = report.textureBytesRead;
+    j["textureBytesDecoded"] = report.textureBytesDecoded;
+    j["meshes"] = report.meshes;
+    j["verticesRead"] = report.verticesRead;
+    j["verticesUnique"] = report.verticesUnique;
+    j["verticesOptimized"] = report.verticesOptimized;
+    j["triangles"] = report.triangles;
+    j["lods"] = report.lods;
+    j["meshlets"] = report.meshlets;
+    j["assets"] = report.assets;
+    return j;
+}
+
+std::string ImportReport::ToJson() const {
+    return ReportToJson(*this).dump();
+}
+
+std::string ReportJson(const std::vector<ImportReport>& reports, double wallMilliseconds) {
+    ImportReport total;
+    total.file = "total";
+    nlohmann::ordered_json files = nlohmann::ordered_json::array();
+    for (const ImportReport& report : reports) {
+        total += report;
+        files.push_back(ReportToJson(report));
+    }
+    nlohmann::ordered_json j;
+    j["wallMilliseconds"] = wallMilliseconds;
+    j["threads"] = ThreadPool::WorkerCount() + 1;
+    j["total"] = ReportToJson(total);
+    j["files"] = std::move(files);
+    return j.dump(4);
 }
 
 void ReadTexture(const std::filesystem::path& path, std::vector<u8>& data, i32& w, i32& h) {
@@ -90,41 +299,656 @@ void ReadTexture(const std::filesystem::path& path, std::vector<u8>& data, i32&
     stbi_image_free(indata);
 }
 
-void ImportTexture(const std::filesystem::path& path, Ref<TextureAsset>& t) {
-    u8* indata = stbi_load(path.string().c_str(), &t->width, &t->height, &t->channels, 4);
-    t->data.resize(t->width * t->height * 4);
-    memcpy(t->data.data(), indata, t->data.size());
-    t->channels = 4;
-    stbi_image_free(indata);
+void ExpandRGBToRGBA(const u8* rgb, u8* rgba, size_t pixelCount) {
+    size_t i = 0;
+#ifdef LUZ_SSSE3
+    // 4 pixels per iteration, the 16 byte load reads 4 bytes ahead so stop 2 pixels early
+    const __m128i shuffle = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    const __m128i alpha = _mm_set1_epi32(0xff000000);
+    for (; i + 6 <= pixelCount; i += 4) {
+        __m128i in = _mm_loadu_si128((const __m128i*)(rgb + i * 3));
+        __m128i out = _mm_or_si128(_mm_shuffle_epi8(in, shuffle), alpha);
+        _mm_storeu_si128((__m128i*)(rgba + i * 4), out);
+    }
+#endif
+    for (; i < pixelCount; i++) {
+        u32 pixel = rgb[i * 3 + 0] | (rgb[i * 3 + 1] << 8) | (rgb[i * 3 + 2] << 16) | 0xff000000;
+        memcpy(rgba + i * 4, &pixel, sizeof(u32));
+    }
+}
+
+// takes ownership of stbi pixels loaded with 3 or 4 components
+void StoreTexturePixels(u8* pixels, i32 w, i32 h, i32 components, TextureAsset& t) {
+    t.width = w;
+    t.height = h;
+    t.channels = 4;
+    t.data.resize(size_t(w) * h * 4);
+    if (components == 3) {
+        ExpandRGBToRGBA(pixels, t.data.data(), size_t(w) * h);
+    } else {
+        memcpy(t.data.data(), pixels, t.data.size());
+    }
+    stbi_image_free(pixels);
+}
+
+void StoreFallbackPixels(TextureAsset& t) {
+    t.width = 1;
+    t.height = 1;
+    t.channels = 4;
+    t.mipLevels = 1;
+    t.encoding = TextureAsset::Encoding::RGBA8;
+    t.data = { 255, 255, 255, 255 };
+}
+
+static constexpr u32 FourCC(const char (&code)[5]) {
+    return u32(code[0]) | (u32(code[1]) << 8) | (u32(code[2]) << 16) | (u32(code[3]) << 24);
+}
+
+struct DDSPixelFormat {
+    u32 size;
+    u32 flags;
+    u32 fourCC;
+    u32 rgbBitCount;
+    u32 rMask;
+    u32 gMask;
+    u32 bMask;
+    u32 aMask;
+};
+
+struct DDSHeader {
+    u32 size;
+    u32 flags;
+    u32 height;
+    u32 width;
+    u32 pitchOrLinearSize;
+    u32 depth;
+    u32 mipMapCount;
+    u32 reserved[11];
+    DDSPixelFormat format;
+    u32 caps[4];
+    u32 reserved2;
+};
+static_assert(sizeof(DDSHeader) == 124);
+
+struct DDSHeaderDX10 {
+    u32 dxgiFormat;
+    u32 resourceDimension;
+    u32 miscFlag;
+    u32 arraySize;
+    u32 miscFlags2;
+};
+
+struct KTX2Header {
+    u8 identifier[12];
+    u32 vkFormat;
+    u32 typeSize;
+    u32 pixelWidth;
+    u32 pixelHeight;
+    u32 pixelDepth;
+    u32 layerCount;
+    u32 faceCount;
+    u32 levelCount;
+    u32 supercompressionScheme;
+    u32 dfdByteOffset;
+    u32 dfdByteLength;
+    u32 kvdByteOffset;
+    u32 kvdByteLength;
+    u64 sgdByteOffset;
+    u64 sgdByteLength;
+};
+static_assert(sizeof(KTX2Header) == 80);
+
+struct KTX2Level {
+    u64 byteOffset;
+    u64 byteLength;
+    u64 uncompressedByteLength;
+};
+
+static constexpr u8 KTX2Identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+static bool IsTextureContainer(const u8* bytes, size_t size) {
+    return (size >= 4 && memcmp(bytes, "DDS ", 4) == 0) || (size >= sizeof(KTX2Identifier) && memcmp(bytes, KTX2Identifier, sizeof(KTX2Identifier)) == 0);
+}
+
+// copies levels stored one after the other, level 0 first, swizzling BGRA to RGBA
+static bool StoreContainerLevels(const u8* bytes, size_t size, const std::vector<size_t>& offsets, bool bgra, TextureAsset& t) {
+    u32 width = u32(t.width);
+    u32 height = u32(t.height);
+    t.data.resize(TextureProcessing::MipOffset(width, height, t.mipLevels, t.encoding));
+    for (u32 level = 0; level < u32(t.mipLevels); level++) {
+        size_t levelSize = TextureProcessing::LevelSize(t.encoding, std::max(1u, width >> level), std::max(1u, height >> level));
+        if (offsets[level] + levelSize > size) {
+            return false;
+        }
+        u8* dst = t.data.data() + TextureProcessing::MipOffset(width, height, level, t.encoding);
+        memcpy(dst, bytes + offsets[level], levelSize);
+        for (size_t i = 0; bgra && i < levelSize; i += 4) {
+            std::swap(dst[i], dst[i + 2]);
+        }
+    }
+    return true;
+}
+
+static bool LoadDDS(const u8* bytes, size_t size, TextureAsset& t) {
+    if (size < 4 + sizeof(DDSHeader)) {
+        return false;
+    }
+    DDSHeader header;
+    memcpy(&header, bytes + 4, sizeof(header));
+    size_t offset = 4 + sizeof(DDSHeader);
+    const u32 cubemap = 0x200;
+    const u32 volume = 0x200000;
+    if ((header.caps[1] & (cubemap | volume)) || header.width == 0 || header.height == 0) {
+        return false;
+    }
+    bool bgra = false;
+    const DDSPixelFormat& format = header.format;
+    if (format.fourCC == FourCC("DX10")) {
+        if (size < offset + sizeof(DDSHeaderDX10)) {
+            return false;
+        }
+        DDSHeaderDX10 dx10;
+        memcpy(&dx10, bytes + offset, sizeof(dx10));
+        offset += sizeof(DDSHeaderDX10);
+        const u32 textureCube = 0x4;
+        if (dx10.arraySize > 1 || (dx10.miscFlag & textureCube)) {
+            return false;
+        }
+        switch (dx10.dxgiFormat) {
+        case 28: case 29: t.encoding = TextureAsset::Encoding::RGBA8; break;
+        case 87: case 91: t.encoding = TextureAsset::Encoding::RGBA8; bgra = true; break;
+        case 71: case 72: t.encoding = TextureAsset::Encoding::BC1; break;
+        case 80: t.encoding = TextureAsset::Encoding::BC4; break;
+        case 83: t.encoding = TextureAsset::Encoding::BC5; break;
+        case 98: case 99: t.encoding = TextureAsset::Encoding::BC7; break;
+        default: return false;
+        }
+    } else if (format.fourCC == FourCC("DXT1")) {
+        t.encoding = TextureAsset::Encoding::BC1;
+    } else if (format.fourCC == FourCC("ATI1") || format.fourCC == FourCC("BC4U")) {
+        t.encoding = TextureAsset::Encoding::BC4;
+    } else if (format.fourCC == FourCC("ATI2") || format.fourCC == FourCC("BC5U")) {
+        t.encoding = TextureAsset::Encoding::BC5;
+    } else if (format.rgbBitCount == 32 && format.rMask == 0x000000ff && format.gMask == 0x0000ff00 && format.bMask == 0x00ff0000) {
+        t.encoding = TextureAsset::Encoding::RGBA8;
+    } else if (format.rgbBitCount == 32 && format.rMask == 0x00ff0000 && format.gMask == 0x0000ff00 && format.bMask == 0x000000ff) {
+        t.encoding = TextureAsset::Encoding::RGBA8;
+        bgra = true;
+    } else {
+        return false;
+    }
+    t.width = header.width;
+    t.height = header.height;
+    t.channels = 4;
+    t.mipLevels = std::clamp(header.mipMapCount, 1u, TextureProcessing::MipLevelCount(header.width, header.height));
+    std::vector<size_t> offsets(t.mipLevels);
+    for (u32 level = 0; level < u32(t.mipLevels); level++) {
+        offsets[level] = offset + TextureProcessing::MipOffset(header.width, header.height, level, t.encoding);
+    }
+    return StoreContainerLevels(bytes, size, offsets, bgra, t);
+}
+
+static bool LoadKTX2(const u8* bytes, size_t size, TextureAsset& t) {
+    if (size < sizeof(KTX2Header)) {
+        return false;
+    }
+    KTX2Header header;
+    memcpy(&header, bytes, sizeof(header));
+    // supercompressed (basis, zstd) files would need a transcoder
+    if (header.pixelDepth > 1 || header.layerCount > 1 || header.faceCount != 1 || header.supercompressionScheme != 0
+        || header.pixelWidth == 0 || header.pixelHeight == 0) {
+        return false;
+    }
+    bool bgra = false;
+    switch (header.vkFormat) {
+    case 37: case 43: t.encoding = TextureAsset::Encoding::RGBA8; break;
+    case 44: case 50: t.encoding = TextureAsset::Encoding::RGBA8; bgra = true; break;
+    case 131: case 132: case 133: case 134: t.encoding = TextureAsset::Encoding::BC1; break;
+    case 139: t.encoding = TextureAsset::Encoding::BC4; break;
+    case 141: t.encoding = TextureAsset::Encoding::BC5; break;
+    case 145: case 146: t.encoding = TextureAsset::Encoding::BC7; break;
+    default: return false;
+    }
+    t.width = header.pixelWidth;
+    t.height = header.pixelHeight;
+    t.channels = 4;
+    t.mipLevels = std::clamp(header.levelCount, 1u, TextureProcessing::MipLevelCount(header.pixelWidth, header.pixelHeight));
+    if (size < sizeof(KTX2Header) + t.mipLevels * sizeof(KTX2Level)) {
+        return false;
+    }
+    std::vector<size_t> offsets(t.mipLevels);
+    for (u32 level = 0; level < u32(t.mipLevels); level++) {
+        KTX2Level index;
+        memcpy(&index, bytes + sizeof(KTX2Header) + level * sizeof(KTX2Level), sizeof(index));
+        size_t expected = TextureProcessing::LevelSize(t.encoding, std::max(1u, header.pixelWidth >> level), std::max(1u, header.pixelHeight >> level));
+        if (index.byteLength != expected) {
+            return false;
+        }
+        offsets[level] = index.byteOffset;
+    }
+    return StoreContainerLevels(bytes, size, offsets, bgra, t);
+}
+
+// fills t with the payload of a dds or ktx2 file, returns false when the layout or format isn't supported
+static bool LoadTextureContainer(const u8* bytes, size_t size, TextureAsset& t) {
+    if (size >= 4 && memcmp(bytes, "DDS ", 4) == 0) {
+        return LoadDDS(bytes, size, t);
+    }
+    return LoadKTX2(bytes, size, t);
+}
+
+// returns true when the bytes held a container payload that must skip mip generation and compression
+bool DecodeTexture(const u8* bytes, size_t size, TextureAsset& t) {
+    if (IsTextureContainer(bytes, size)) {
+        if (LoadTextureContainer(bytes, size, t)) {
+            return true;
+        }
+        LOG_ERROR("Failed to decode texture {}: unsupported container layout or format", t.name);
+        StoreFallbackPixels(t);
+        return false;
+    }
+    i32 w, h, components;
+    if (!stbi_info_from_memory(bytes, (int)size, &w, &h, &components)) {
+        LOG_ERROR("Failed to decode texture {}: {}", t.name, stbi_failure_reason());
+        StoreFallbackPixels(t);
+        return false;
+    }
+    i32 request = components == 3 ? 3 : 4;
+    u8* pixels = stbi_load_from_memory(bytes, (int)size, &w, &h, &components, request);
+    if (!pixels) {
+        LOG_ERROR("Failed to decode texture {}: {}", t.name, stbi_failure_reason());
+        StoreFallbackPixels(t);
+        return false;
+    }
+    StoreTexturePixels(pixels, w, h, request, t);
+    return false;
+}
+
+// returns true when the texture was loaded from a container and must skip mip generation and compression
+bool ImportTexture(const std::filesystem::path& path, Ref<TextureAsset>& t) {
+    if (IsTextureContainer(path)) {
+        Ref<MappedFile> file = MapFile(path);
+        if (file && IsTextureContainer(file->data, file->size) && LoadTextureContainer(file->data, file->size, *t)) {
+            return true;
+        }
+        LOG_ERROR("Failed to load texture {}: unsupported container layout or format", path.string());
+        StoreFallbackPixels(*t);
+        return false;
+    }
+    i32 w, h, components;
+    u8* pixels = nullptr;
+    i32 request = 4;
+    if (stbi_info(path.string().c_str(), &w, &h, &components)) {
+        request = components == 3 ? 3 : 4;
+        pixels = stbi_load(path.string().c_str(), &w, &h, &components, request);
+    }
+    if (!pixels) {
+        LOG_ERROR("Failed to load texture {}: {}", path.string(), stbi_failure_reason());
+        StoreFallbackPixels(*t);
+        return false;
+    }
+    StoreTexturePixels(pixels, w, h, request, *t);
+    return false;
 }
 
-UUID ImportTexture(const std::filesystem::path& path, AssetManager& assets) {
+UUID ImportTexture(const std::filesystem::path& path, AssetManager& assets, ImportReport* report) {
+    ImportReport localReport;
+    ImportReport& r = report ? *report : localReport;
     auto t = assets.CreateAsset<TextureAsset>(path.stem().string());
-    ImportTexture(path, t);
+    bool native = false;
+    {
+        StageTimer timer{ r, ImportReport::TextureDecode };
+        native = ImportTexture(path, t);
+    }
+    u64 size = FileSize(path);
+    r.bytesRead += size;
+    r.textures++;
+    r.textureBytesRead += size;
+    r.textureBytesDecoded += t->data.size();
+    if (!native) {
+        StageTimer timer{ r, ImportReport::TextureProcess };
+        TextureProcessing::GenerateMips(*t);
+        TextureProcessing::Compress(*t);
+    }
     return t->uuid;
 }
 
-UUID ImportScene(const std::filesystem::path& path, AssetManager& assets) {
+UUID ImportScene(const std::filesystem::path& path, AssetManager& assets, const ImportSettings& settings, ImportProgress* progress, ImportReport* report) {
+    ImportReport localReport;
+    ImportReport& r = report ? *report : localReport;
     const std::string ext = path.extension().string();
     if (ext == ".gltf" || ext == ".glb") {
-        return ImportSceneGLTF(path, assets);
+        return ImportSceneGLTF(path, assets, settings, progress, r);
     } else if (ext == ".obj") {
-        return ImportSceneOBJ(path, assets);
+        return ImportSceneOBJ(path, assets, settings, progress, r);
+    } else if (ext == ".ply") {
+        return ImportScenePLY(path, assets, settings, progress, r);
     }
     return 0;
 }
 
-UUID ImportSceneGLTF(const std::filesystem::path& path, AssetManager& manager) {
+// a texture sampled by slots with different content (e.g. an ORM map used for occlusion and metallic roughness)
+// keeps every channel as plain data
+void AssignContent(TextureAsset& texture, TextureAsset::Content content) {
+    if (texture.content != TextureAsset::Content::Color && texture.content != content) {
+        texture.content = TextureAsset::Content::Data;
+    } else {
+        texture.content = content;
+    }
+}
+
+// runs after materials assigned the content of every texture
+void ProcessTextures(const std::vector<Ref<TextureAsset>>& textures, const ImportSettings& settings, ImportReport& report) {
+    StageTimer timer{ report, ImportReport::TextureProcess };
+    ThreadPool::ParallelFor(u32(textures.size()), [&](u32 i) {
+        if (settings.generateMips) {
+            TextureProcessing::GenerateMips(*textures[i]);
+        }
+        if (settings.compressTextures) {
+            TextureProcessing::Compress(*textures[i]);
+        }
+    });
+}
+
+// post processing shared by all scene importers, meshes are processed in parallel
+void ProcessMeshes(const std::vector<Ref<MeshAsset>>& meshes, const ImportSettings& settings, ImportReport& report) {
+    report.meshes += meshes.size();
+    for (const Ref<MeshAsset>& mesh : meshes) {
+        report.verticesUnique += mesh->vertices.size();
+    }
+    if (settings.generateTangents) {
+        StageTimer timer{ report, ImportReport::Tangents };
+        ThreadPool::ParallelFor(u32(meshes.size()), [&](u32 i) {
+            if (!MeshProcessing::HasTangents(*meshes[i])) {
+                MeshProcessing::GenerateTangents(*meshes[i]);
+            }
+        });
+    }
+    if (settings.optimizeMeshes) {
+        StageTimer timer{ report, ImportReport::Optimize };
+        std::vector<MeshProcessing::VertexCacheStats> before(meshes.size());
+        std::vector<MeshProcessing::VertexCacheStats> after(meshes.size());
+        ThreadPool::ParallelFor(u32(meshes.size()), [&](u32 i) {
+            MeshProcessing::Optimize(*meshes[i], before[i], after[i]);
+        });
+        MeshProcessing::VertexCacheStats totalBefore;
+        MeshProcessing::VertexCacheStats totalAfter;
+        for (u32 i = 0; i < meshes.size(); i++) {
+            totalBefore += before[i];
+            totalAfter += after[i];
+        }
+        LOG_INFO("Optimized {} meshes: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}", meshes.size(), totalBefore.ACMR(), totalAfter.ACMR(), totalBefore.ATVR(), totalAfter.ATVR());
+    }
+    for (const Ref<MeshAsset>& mesh : meshes) {
+        report.verticesOptimized += mesh->vertices.size();
+        report.triangles += mesh->indices.size() / 3;
+    }
+    {
+        StageTimer timer{ report, ImportReport::Lods };
+        ThreadPool::ParallelFor(u32(meshes.size()), [&](u32 i) {
+            MeshAsset& mesh = *meshes[i];
+            mesh.packedVertices = settings.packVertices;
+            MeshProcessing::ComputeBounds(mesh);
+            if (settings.generateLods) {
+                MeshProcessing::GenerateLods(mesh);
+            } else {
+                mesh.lods = { { 0, u32(mesh.indices.size()), 0, 0, 0.0f } };
+            }
+        });
+    }
+    {
+        StageTimer timer{ report, ImportReport::Meshlets };
+        ThreadPool::ParallelFor(u32(meshes.size()), [&](u32 i) {
+            MeshAsset& mesh = *meshes[i];
+            mesh.meshlets.clear();
+            if (settings.buildMeshlets) {
+                for (MeshAsset::Lod& lod : mesh.lods) {
+                    lod.firstMeshlet = u32(mesh.meshlets.size());
+                    MeshProcessing::BuildMeshlets(mesh, lod.firstIndex, lod.indexCount, mesh.meshlets);
+                    lod.meshletCount = u32(mesh.meshlets.size()) - lod.firstMeshlet;
+                }
+            }
+        });
+    }
+    size_t lodCount = 0;
+    for (const Ref<MeshAsset>& mesh : meshes) {
+        lodCount += mesh->lods.size();
+        report.meshlets += mesh->meshlets.size();
+    }
+    report.lods += lodCount;
+    if (settings.generateLods) {
+        LOG_INFO("Generated {} levels of detail for {} meshes", lodCount, meshes.size());
+    }
+}
+
+// meshopt compressed glTF files keep the encoded bytes in one buffer and declare the decoded size of a fallback
+// buffer without data, which tinygltf refuses to load. fallbacks get a small data uri before parsing and every
+// compressed view is decoded into a buffer of its own afterwards
+static constexpr const char* MeshoptExtensions[] = { "EXT_meshopt_compression", "KHR_meshopt_compression" };
+
+static bool PatchMeshoptFallbacks(std::string& json) {
+    if (json.find("meshopt_compression") == std::string::npos) {
+        return false;
+    }
+    nlohmann::json gltf = nlohmann::json::parse(json, nullptr, false);
+    if (gltf.is_discarded() || !gltf.contains("buffers") || !gltf["buffers"].is_array()) {
+        return false;
+    }
+    bool patched = false;
+    for (auto& buffer : gltf["buffers"]) {
+        if (!buffer.contains("extensions")) {
+            continue;
+        }
+        for (const char* name : MeshoptExtensions) {
+            auto ext = buffer["extensions"].find(name);
+            if (ext != buffer["extensions"].end() && ext->is_object() && ext->value("fallback", false)) {
+                buffer["uri"] = "data:application/octet-stream;base64,AAAAAA==";
+                buffer["byteLength"] = 4;
+                patched = true;
+            }
+        }
+    }
+    if (patched) {
+        json = gltf.dump();
+    }
+    return patched;
+}
+
+// rebuilds a glb with the patched json chunk, empty when nothing needed patching
+static std::vector<u8> PatchMeshoptFallbacks(const u8* data, size_t size) {
+    // magic, version, length, then the length and type of the json chunk
+    u32 header[5];
+    if (size < sizeof(header)) {
+        return {};
+    }
+    memcpy(header, data, sizeof(header));
+    if (header[0] != 0x46546C67 || header[4] != 0x4E4F534A || sizeof(header) + header[3] > size) {
+        return {};
+    }
+    std::string json((const char*)data + sizeof(header), header[3]);
+    if (!PatchMeshoptFallbacks(json)) {
+        return {};
+    }
+    json.resize(ALIGN_AS(json.size(), 4), ' ');
+    size_t rest = sizeof(header) + header[3];
+    std::vector<u8> glb(sizeof(header) + json.size() + size - rest);
+    header[2] = u32(glb.size());
+    header[3] = u32(json.size());
+    memcpy(glb.data(), header, sizeof(header));
+    memcpy(glb.data() + sizeof(header), json.data(), json.size());
+    memcpy(glb.data() + sizeof(header) + json.size(), data + rest, size - rest);
+    return glb;
+}
+
+static bool DecodeMeshoptViews(tinygltf::Model& model) {
+    std::vector<std::pair<u32, const tinygltf::Value*>> views;
+    for (u32 i = 0; i < model.bufferViews.size(); i++) {
+        for (const char* name : MeshoptExtensions) {
+            auto ext = model.bufferViews[i].extensions.find(name);
+            if (ext != model.bufferViews[i].extensions.end()) {
+                views.emplace_back(i, &ext->second);
+                break;
+            }
+        }
+    }
+    std::vector<std::vector<u8>> decoded(views.size());
+    std::vector<u8> decodedViews(views.size(), 0);
+    ThreadPool::ParallelFor(u32(views.size()), [&](u32 i) {
+        const tinygltf::Value& ext = *views[i].second;
+        const auto number = [&](const char* field) {
+            return ext.Get(field).IsNumber() ? size_t(ext.Get(field).GetNumberAsDouble()) : 0;
+        };
+        size_t buffer = number("buffer");
+        size_t offset = number("byteOffset");
+        size_t length = number("byteLength");
+        size_t stride = number("byteStride");
+        size_t count = number("count");
+        std::string mode = ext.Get("mode").IsString() ? ext.Get("mode").Get<std::string>() : "";
+        std::string filter = ext.Get("filter").IsString() ? ext.Get("filter").Get<std::string>() : "NONE";
+        if (buffer >= model.buffers.size() || offset + length > model.buffers[buffer].data.size()) {
+            return;
+        }
+        const u8* source = model.buffers[buffer].data.data() + offset;
+        decoded[i].resize(count * stride);
+        if (mode == "ATTRIBUTES") {
+            decodedViews[i] = GeometryCodec::DecodeVertices(decoded[i].data(), count, stride, source, length);
+            GeometryCodec::Filter filters[] = { GeometryCodec::Filter::Octahedral, GeometryCodec::Filter::Quaternion, GeometryCodec::Filter::Exponential };
+            const char* filterNames[] = { "OCTAHEDRAL", "QUATERNION", "EXPONENTIAL" };
+            for (u32 f = 0; f < COUNT_OF(filters); f++) {
+                if (decodedViews[i] && filter == filterNames[f]) {
+                    GeometryCodec::DecodeFilter(filters[f], decoded[i].data(), count, stride);
+                }
+            }
+        } else if (mode == "TRIANGLES") {
+            decodedViews[i] = GeometryCodec::DecodeTriangles(decoded[i].data(), count, stride, source, length);
+        } else if (mode == "INDICES") {
+            decodedViews[i] = GeometryCodec::DecodeIndexSequence(decoded[i].data(), count, stride, source, length);
+        }
+    });
+    for (u32 i = 0; i < views.size(); i++) {
+        if (!decodedViews[i]) {
+            LOG_ERROR("Failed to decode compressed buffer view {}", views[i].first);
+            return false;
+        }
+        tinygltf::BufferView& view = model.bufferViews[views[i].first];
+        view.buffer = int(model.buffers.size());
+        view.byteOffset = 0;
+        view.byteLength = decoded[i].size();
+        model.buffers.emplace_back().data = std::move(decoded[i]);
+    }
+    return true;
+}
+
+// KHR_mesh_quantization allows integer attributes, normalized ones map to [0, 1] or [-1, 1]
+static float ReadComponent(const u8* data, int componentType, bool normalized) {
+    switch (componentType) {
+    case TINYGLTF_COMPONENT_TYPE_FLOAT: {
+        float value;
+        memcpy(&value, data, sizeof(value));
+        return value;
+    }
+    case TINYGLTF_COMPONENT_TYPE_BYTE:
+        return normalized ? std::max(*(const i8*)data / 127.0f, -1.0f) : *(const i8*)data;
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+        return normalized ? *data / 255.0f : *data;
+    case TINYGLTF_COMPONENT_TYPE_SHORT: {
+        i16 value;
+        memcpy(&value, data, sizeof(value));
+        return normalized ? std::max(value / 32767.0f, -1.0f) : value;
+    }
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: {
+        u16 value;
+        memcpy(&value, data, sizeof(value));
+        return normalized ? value / 65535.0f : value;
+    }
+    case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT: {
+        u32 value;
+        memcpy(&value, data, sizeof(value));
+        return float(value);
+    }
+    default:
+        return 0.0f;
+    }
+}
+
+// KHR_texture_transform of the base color texture, baked into the texture coordinates of the primitive
+struct TextureTransform {
+    glm::vec2 offset = glm::vec2(0.0f);
+    glm::vec2 scale = glm::vec2(1.0f);
+    float rotation = 0.0f;
+
+    bool IsIdentity() const {
+        return offset == glm::vec2(0.0f) && scale == glm::vec2(1.0f) && rotation == 0.0f;
+    }
+
+    glm::vec2 Apply(glm::vec2 uv) const {
+        uv *= scale;
+        float c = std::cos(rotation);
+        float s = std::sin(rotation);
+        return glm::vec2(c * uv.x + s * uv.y, c * uv.y - s * uv.x) + offset;
+    }
+};
+
+static TextureTransform GetTextureTransform(const tinygltf::Material& material) {
+    TextureTransform transform;
+    const tinygltf::ExtensionMap& extensions = material.pbrMetallicRoughness.baseColorTexture.extensions;
+    auto ext = extensions.find("KHR_texture_transform");
+    if (ext == extensions.end()) {
+        return transform;
+    }
+    const auto vec2 = [&](const char* field, glm::vec2& value) {
+        const tinygltf::Value& array = ext->second.Get(field);
+        if (array.IsArray() && array.ArrayLen() == 2) {
+            value = glm::vec2(array.Get(0).GetNumberAsDouble(), array.Get(1).GetNumberAsDouble());
+        }
+    };
+    vec2("offset", transform.offset);
+    vec2("scale", transform.scale);
+    if (ext->second.Get("rotation").IsNumber()) {
+        transform.rotation = float(ext->second.Get("rotation").GetNumberAsDouble());
+    }
+    return transform;
+}
+
+UUID ImportSceneGLTF(const std::filesystem::path& path, AssetManager& manager, const ImportSettings& settings, ImportProgress* progress, ImportReport& report) {
     tinygltf::Model model;
     tinygltf::TinyGLTF loader;
     std::string err;
     std::string warn;
 
+    // keep the encoded bytes, images are decoded in parallel after parsing
+    loader.SetImageLoader([](tinygltf::Image* image, const int, std::string*, std::string*, int, int, const unsigned char* bytes, int size, void*) {
+        image->image.assign(bytes, bytes + size);
+        image->as_is = true;
+        return true;
+    }, nullptr);
+
     bool ret = false;
-    if (path.extension() == ".gltf") {
-        ret = loader.LoadASCIIFromFile(&model, &err, &warn, path.string());
-    } else {
-        ret = loader.LoadBinaryFromFile(&model, &err, &warn, path.string());
+    {
+        StageTimer timer{ report, ImportReport::Parse };
+        if (path.extension() == ".gltf") {
+            std::string json = ReadFile(path);
+            report.bytesRead += json.size();
+            PatchMeshoptFallbacks(json);
+            ret = loader.LoadASCIIFromString(&model, &err, &warn, json.c_str(), (unsigned int)json.size(), path.parent_path().string());
+        } else if (Ref<MappedFile> file = MapFile(path)) {
+            report.bytesRead += file->size;
+            std::vector<u8> patched = PatchMeshoptFallbacks(file->data, file->size);
+            const u8* bytes = patched.empty() ? file->data : patched.data();
+            size_t size = patched.empty() ? file->size : patched.size();
+            ret = loader.LoadBinaryFromMemory(&model, &err, &warn, bytes, (unsigned int)size, path.parent_path().string());
+        } else {
+            err = "Failed to map " + path.string();
+        }
+        // buffers and images stored next to the gltf file
+        const auto external = [](const std::string& uri) { return !uri.empty() && uri.rfind("data:", 0) != 0; };
+        for (const tinygltf::Buffer& buffer : model.buffers) {
+            report.bytesRead += external(buffer.uri) ? buffer.data.size() : 0;
+        }
+        for (const tinygltf::Image& image : model.images) {
+            report.bytesRead += external(image.uri) ? image.image.size() : 0;
+        }
+        ret = ret && DecodeMeshoptViews(model);
     }
 
     if (!warn.empty()) {
@@ -140,34 +964,53 @@ UUID ImportSceneGLTF(const std::filesystem::path& path, AssetManager& manager) {
       return 0;
     }
 
+    if (NextStep(progress)) {
+        return 0;
+    }
+
     const tinygltf::Scene& scene = model.scenes[model.defaultScene];
     const auto getBuffer = [&](auto& accessor, auto& view) { return &model.buffers[view.buffer].data[view.byteOffset + accessor.byteOffset]; };
 
+    // textures only differing by sampler share the asset of their image
+    std::vector<Ref<TextureAsset>> imageTextures(model.images.size());
     std::vector<Ref<TextureAsset>> loadedTextures(model.textures.size());
     for (int i = 0; i < model.textures.size(); i++) {
-        tinygltf::Texture texture = model.textures[i];
-        tinygltf::Image image = model.images[texture.source];
-        std::vector<u8> buffer(image.width * image.height * 4);
-        if (image.component == 3) {
-            unsigned char* rgba = buffer.data(); 
-            unsigned char* rgb = image.image.data();
-            for (u32 j = 0; j < image.width * image.height; j++) {
-                rgba[0] = rgb[0];
-                rgba[1] = rgb[1];
-                rgba[2] = rgb[2];
-                rgba += 4;
-                rgb += 3;
-            }
+        int source = model.textures[i].source;
+        // MSFT_texture_dds points to a dds image while source keeps a fallback for other loaders
+        auto dds = model.textures[i].extensions.find("MSFT_texture_dds");
+        if (dds != model.textures[i].extensions.end() && dds->second.Get("source").IsInt()) {
+            source = dds->second.Get("source").GetNumberAsInt();
+        }
+        if (source < 0 || source >= model.images.size()) {
+            loadedTextures[i] = manager.CreateAsset<TextureAsset>(model.textures[i].name);
+            StoreFallbackPixels(*loadedTextures[i]);
+        } else if (!imageTextures[source]) {
+            loadedTextures[i] = imageTextures[source] = manager.CreateAsset<TextureAsset>(model.textures[i].name);
         } else {
-            memcpy(buffer.data(), image.image.data(), image.width * image.height * 4);
+            loadedTextures[i] = imageTextures[source];
+        }
+    }
+    std::vector<u32> pendingImages;
+    for (u32 i = 0; i < imageTextures.size(); i++) {
+        if (imageTextures[i]) {
+            pendingImages.push_back(i);
         }
-        loadedTextures[i] = manager.CreateAsset<TextureAsset>(texture.name);
-        loadedTextures[i]->data = buffer;
-        loadedTextures[i]->width = image.width;
-        loadedTextures[i]->height = image.height;
-        loadedTextures[i]->channels = 4;
+    }
+    std::vector<u8> nativeImages(model.images.size(), 0);
+    {
+        StageTimer timer{ report, ImportReport::TextureDecode };
+        ThreadPool::ParallelFor((u32)pendingImages.size(), [&](u32 i) {
+            const tinygltf::Image& image = model.images[pendingImages[i]];
+            nativeImages[pendingImages[i]] = DecodeTexture(image.image.data(), image.image.size(), *imageTextures[pendingImages[i]]);
+        });
+    }
+    for (u32 image : pendingImages) {
+        report.textures++;
+        report.textureBytesRead += model.images[image].image.size();
+        report.textureBytesDecoded += imageTextures[image]->data.size();
     }
 
+    StageTimer timer{ report, ImportReport::Scene };
     std::vector<Ref<MaterialAsset>> materials(model.materials.size());
 
     for (int i = 0; i < materials.size(); i++) {
@@ -179,6 +1022,7 @@ UUID ImportSceneGLTF(const std::filesystem::path& path, AssetManager& manager) {
         }
         if (mat.values.find("metallicRoughnessTexture") != mat.values.end()) {
             materials[i]->metallicRoughnessMap = loadedTextures[mat.values["metallicRoughnessTexture"].TextureIndex()];
+            AssignContent(*materials[i]->metallicRoughnessMap, TextureAsset::Content::Data);
         }
         if (mat.values.find("baseColorFactor") != mat.values.end()) {
             materials[i]->color = glm::make_vec4(mat.values["baseColorFactor"].ColorFactor().data());
@@ -192,17 +1036,33 @@ UUID ImportSceneGLTF(const std::filesystem::path& path, AssetManager& manager) {
         // additional
         if (mat.additionalValues.find("normalTexture") != mat.additionalValues.end()) {
             materials[i]->normalMap = loadedTextures[mat.additionalValues["normalTexture"].TextureIndex()];
+            AssignContent(*materials[i]->normalMap, TextureAsset::Content::Normal);
         }
         if (mat.additionalValues.find("emissiveTexture") != mat.additionalValues.end()) {
             materials[i]->emissionMap = loadedTextures[mat.additionalValues["emissiveTexture"].TextureIndex()];
         }
         if (mat.additionalValues.find("occlusionTexture") != mat.additionalValues.end()) {
             materials[i]->aoMap = loadedTextures[mat.additionalValues["occlusionTexture"].TextureIndex()];
+            AssignContent(*materials[i]->aoMap, TextureAsset::Content::Occlusion);
         }
         if (mat.additionalValues.find("emissiveFactor") != mat.additionalValues.end()) {
             materials[i]->emission = glm::make_vec3(mat.additionalValues["emissiveFactor"].ColorFactor().data());
         }
     }
+    // dds and ktx2 images are uploaded as stored
+    std::vector<Ref<TextureAsset>> uniqueTextures;
+    for (u32 i = 0; i < imageTextures.size(); i++) {
+        if (imageTextures[i] && !nativeImages[i]) {
+            uniqueTextures.push_back(imageTextures[i]);
+        }
+    }
+    timer.Stop();
+    ProcessTextures(uniqueTextures, settings, report);
+    if (NextStep(progress)) {
+        return 0;
+    }
+
+    timer.Next(ImportReport::Geometry);
 
     std::vector<Ref<MeshAsset>> loadedMeshes;
     std::vector<int> loadedMeshMaterials;
@@ -213,10 +1073,10 @@ UUID ImportSceneGLTF(const std::filesystem::path& path, AssetManager& manager) {
             Ref<MeshAsset>& desc = loadedMeshes.emplace_back(manager.CreateAsset<MeshAsset>(name));
             loadedMeshMaterials.emplace_back(primitive.material);
 
-            float* bufferPos = nullptr;
-            float* bufferNormals = nullptr;
-            float* bufferTangents = nullptr;
-            float* bufferUV = nullptr;
+            const u8* bufferPos = nullptr;
+            const u8* bufferNormals = nullptr;
+            const u8* bufferTangents = nullptr;
+            const u8* bufferUV = nullptr;
 
             int stridePos = 0;
             int strideNormals = 0;
@@ -226,129 +1086,102 @@ UUID ImportSceneGLTF(const std::filesystem::path& path, AssetManager& manager) {
             u32 vertexCount = 0;
             u32 indexCount = 0;
 
-            // position
-            {
-                auto it = primitive.attributes.find("POSITION");
-                DEBUG_ASSERT(it != primitive.attributes.end(), "Primitive don't have position attribute");
-                const tinygltf::Accessor accessor = model.accessors[it->second];
-                const tinygltf::BufferView bufferView = model.bufferViews[accessor.bufferView];
-                bufferPos = (float*)getBuffer(accessor, bufferView);
-                stridePos = accessor.ByteStride(bufferView) / sizeof(float);
-                vertexCount = accessor.count;
-            }
-
-            // normal
-            {
-                auto it = primitive.attributes.find("NORMAL");
-                if (it != primitive.attributes.end()) {
-                    const tinygltf::Accessor accessor = model.accessors[it->second];
-                    const tinygltf::BufferView bufferView = model.bufferViews[accessor.bufferView];
-                    bufferNormals = (float*)getBuffer(accessor, bufferView);
-                    strideNormals = accessor.ByteStride(bufferView) / sizeof(float);
+            const auto findAttribute = [&](const char* attribute, const u8*& buffer, int& stride) -> const tinygltf::Accessor* {
+                auto it = primitive.attributes.find(attribute);
+                if (it == primitive.attributes.end()) {
+                    return nullptr;
                 }
-            }
+                const tinygltf::Accessor& accessor = model.accessors[it->second];
+                const tinygltf::BufferView& bufferView = model.bufferViews[accessor.bufferView];
+                buffer = getBuffer(accessor, bufferView);
+                stride = accessor.ByteStride(bufferView);
+                return &accessor;
+            };
 
-            // tangent
-            {
-                auto it = primitive.attributes.find("TANGENT");
-                if (it != primitive.attributes.end()) {
-                    const tinygltf::Accessor accessor = model.accessors[it->second];
-                    const tinygltf::BufferView bufferView = model.bufferViews[accessor.bufferView];
-                    bufferTangents = (float*)getBuffer(accessor, bufferView);
-                    strideTangents = accessor.ByteStride(bufferView) / sizeof(float);
-                }
-            }
+            const tinygltf::Accessor* accessorPos = findAttribute("POSITION", bufferPos, stridePos);
+            const tinygltf::Accessor* accessorNormals = findAttribute("NORMAL", bufferNormals, strideNormals);
+            const tinygltf::Accessor* accessorTangents = findAttribute("TANGENT", bufferTangents, strideTangents);
+            const tinygltf::Accessor* accessorUV = findAttribute("TEXCOORD_0", bufferUV, strideUV);
+            DEBUG_ASSERT(accessorPos != nullptr, "Primitive don't have position attribute");
+            vertexCount = accessorPos->count;
+            report.verticesRead += vertexCount;
 
-            // uvs
-            {
-                auto it = primitive.attributes.find("TEXCOORD_0");
-                if (it != primitive.attributes.end()) {
-                    const tinygltf::Accessor accessor = model.accessors[it->second];
-                    const tinygltf::BufferView bufferView = model.bufferViews[accessor.bufferView];
-                    bufferUV = (float*)getBuffer(accessor, bufferView);
-                    strideUV = accessor.ByteStride(bufferView) / sizeof(float);
+            // vertices, interleaved float buffers with the MeshVertex layout are copied at once
+            const auto matchesVertex = [&](const tinygltf::Accessor* accessor, size_t offset) {
+                return accessor && accessor->componentType == TINYGLTF_COMPONENT_TYPE_FLOAT && !accessor->sparse.isSparse
+                    && accessor->bufferView == accessorPos->bufferView && accessor->byteOffset == accessorPos->byteOffset + offset;
+            };
+            bool sameLayout = stridePos == sizeof(MeshAsset::MeshVertex) && matchesVertex(accessorPos, 0)
+                && matchesVertex(accessorNormals, offsetof(MeshAsset::MeshVertex, normal))
+                && matchesVertex(accessorTangents, offsetof(MeshAsset::MeshVertex, tangent))
+                && matchesVertex(accessorUV, offsetof(MeshAsset::MeshVertex, texCoord));
+            // quantized texture coordinates come with the transform that restores them on the material
+            TextureTransform uvTransform = primitive.material >= 0 ? GetTextureTransform(model.materials[primitive.material]) : TextureTransform();
+            desc->vertices.resize(vertexCount);
+            if (sameLayout && uvTransform.IsIdentity()) {
+                memcpy(desc->vertices.data(), bufferPos, vertexCount * sizeof(MeshAsset::MeshVertex));
+            } else {
+                const auto read = [](const tinygltf::Accessor* accessor, const u8* buffer, int stride, u32 v, int components) {
+                    glm::vec4 value(0.0f);
+                    size_t componentSize = tinygltf::GetComponentSizeInBytes(accessor->componentType);
+                    for (int c = 0; c < components; c++) {
+                        value[c] = ReadComponent(buffer + v * stride + c * componentSize, accessor->componentType, accessor->normalized);
+                    }
+                    return value;
+                };
+                for (u32 v = 0; v < vertexCount; v++) {
+                    MeshAsset::MeshVertex& vertex = desc->vertices[v];
+                    vertex.position = read(accessorPos, bufferPos, stridePos, v, 3);
+                    vertex.normal = bufferNormals ? read(accessorNormals, bufferNormals, strideNormals, v, 3) : glm::vec4(0);
+                    vertex.texCoord = bufferUV ? uvTransform.Apply(read(accessorUV, bufferUV, strideUV, v, 2)) : glm::vec2(0);
+                    vertex.tangent = bufferTangents ? read(accessorTangents, bufferTangents, strideTangents, v, 4) : glm::vec4(0);
                 }
             }
 
-            // vertices
-            for (u32 v = 0; v < vertexCount; v++) {
-                MeshAsset::MeshVertex vertex{};
-                vertex.position = glm::make_vec3(&bufferPos[v * stridePos]);
-                vertex.normal = bufferNormals ? glm::make_vec3(&bufferNormals[v * strideNormals]) : glm::vec3(0);
-                vertex.texCoord = bufferUV ? glm::make_vec3(&bufferUV[v * strideUV]) : glm::vec3(0);
-                vertex.tangent = bufferTangents ? glm::make_vec4(&bufferTangents[v * strideTangents]) : glm::vec4(0);
-                desc->vertices.push_back(vertex);
-            }
-
             // indices
             DEBUG_ASSERT(primitive.indices > -1, "Non indexed primitive not supported!");
             {
-                const tinygltf::Accessor accessor = model.accessors[primitive.indices];
-                const tinygltf::BufferView bufferView = model.bufferViews[accessor.bufferView];
+                const tinygltf::Accessor& accessor = model.accessors[primitive.indices];
+                const tinygltf::BufferView& bufferView = model.bufferViews[accessor.bufferView];
                 indexCount = accessor.count;
-                auto pushIndices = [&](auto* bufferIndex) {
+                desc->indices.resize(indexCount);
+                auto copyIndices = [&](auto* bufferIndex) {
                     for (u32 i = 0; i < indexCount; i++) {
-                        desc->indices.push_back(bufferIndex[i]);
+                        desc->indices[i] = bufferIndex[i];
                     }
                 };
                 switch (accessor.componentType) {
                 case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
-                    pushIndices((u32*)getBuffer(accessor, bufferView));
+                    memcpy(desc->indices.data(), getBuffer(accessor, bufferView), indexCount * sizeof(u32));
                     break;
                 case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
-                    pushIndices((u16*)getBuffer(accessor, bufferView));
+                    copyIndices((u16*)getBuffer(accessor, bufferView));
                     break;
                 case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
-                    pushIndices((u8*)getBuffer(accessor, bufferView));
+                    copyIndices((u8*)getBuffer(accessor, bufferView));
                     break;
                 default:
                     DEBUG_ASSERT(false, "Index type not supported!");
                 }
             }
-
-            // calculate tangents
-            if (!bufferTangents) {
-                glm::vec3* tan1 = new glm::vec3[desc->vertices.size()*2];
-                glm::vec3* tan2 = tan1 + vertexCount;
-                for (int indexID = 0; indexID < desc->indices.size(); indexID += 3) {
-                    int index1 = desc->indices[indexID + 0];
-                    int index2 = desc->indices[indexID + 2];
-                    int index3 = desc->indices[indexID + 1];
-                    const auto& v1 = desc->vertices[index1];
-                    const auto& v2 = desc->vertices[index2];
-                    const auto& v3 = desc->vertices[index3];
-                    glm::vec3 e1 = v2.position - v1.position;
-                    glm::vec3 e2 = v3.position - v1.position;
-                    glm::vec2 duv1 = v2.texCoord - v1.texCoord;
-                    glm::vec2 duv2 = v3.texCoord - v1.texCoord;
-                    float f = 1.0f / (duv1.x * duv2.y - duv2.x * duv1.y);
-                    glm::vec3 sdir = f * (duv2.y * e1 - duv1.y * e2);
-                    glm::vec3 tdir = f * (duv1.x * e2 - duv2.x * e1);
-                    tan1[index1] += sdir;
-                    tan1[index2] += sdir;
-                    tan1[index3] += sdir;
-                    tan2[index1] += tdir;
-                    tan2[index2] += tdir;
-                    tan2[index3] += tdir;
-                }
-                for (int a = 0; a < desc->vertices.size(); a++) {
-                    glm::vec3 t = tan1[a];
-                    auto& v = desc->vertices[a];
-                    glm::vec3 n = v.normal;
-                    v.tangent = glm::vec4(glm::normalize(t - n * glm::dot(t, n)), 1.0);
-                    v.tangent.w = (glm::dot(glm::cross(n, t), tan2[a]) < 0.0f) ? -1.0f : 1.0f;
-                }
-                delete[] tan1;
-            }
         }
     }
 
+    timer.Stop();
+    if (NextStep(progress)) {
+        return 0;
+    }
+    ProcessMeshes(loadedMeshes, settings, report);
+
+    timer.Next(ImportReport::Scene);
+
     std::vector<Ref<Node>> loadedNodes;
     for (const tinygltf::Node& node : model.nodes) {
         Ref<Node> groupNode = manager.CreateObject<Node>(node.name);
         if (node.mesh >= 0) {
             Ref<MeshNode> meshNode = manager.CreateObject<MeshNode>(node.name);
             meshNode->mesh = loadedMeshes[node.mesh];
+            meshNode->isStatic = true;
             int matId = loadedMeshMaterials[node.mesh];
             if (matId >= 0) {
                 meshNode->material = materials[matId];
@@ -402,33 +1235,261 @@ UUID ImportSceneGLTF(const std::filesystem::path& path, AssetManager& manager) {
     return loadedScenes.size() ? loadedScenes[0]->uuid : 0;
 }
 
-UUID ImportSceneOBJ(const std::filesystem::path& path, AssetManager& manager) {
+struct ObjRun {
+    u32 firstCorner = 0;
+    std::string name;
+    bool isMaterial = false;
+};
+
+struct ObjChunk {
+    const char* begin = nullptr;
+    const char* end = nullptr;
+    u32 positionCount = 0;
+    u32 normalCount = 0;
+    u32 texCoordCount = 0;
+    u32 firstPosition = 0;
+    u32 firstNormal = 0;
+    u32 firstTexCoord = 0;
+    // absolute position, texcoord and normal index per triangle corner, -1 when missing
+    std::vector<glm::ivec3> corners;
+    std::vector<ObjRun> runs;
+    std::vector<std::string> mtllibs;
+};
+
+struct ObjSegment {
+    u32 chunk;
+    u32 begin;
+    u32 end;
+};
+
+struct ObjMesh {
+    std::string object;
+    std::string material;
+    std::vector<ObjSegment> segments;
+    u32 cornerCount = 0;
+    Ref<MeshAsset> asset;
+};
+
+const char* ObjSkipSpaces(const char* p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t')) {
+        p++;
+    }
+    return p;
+}
+
+const char* ObjLineEnd(const char* p, const char* end) {
+    const char* newline = (const char*)memchr(p, '\n', end - p);
+    return newline ? newline : end;
+}
+
+bool ObjKeyword(const char* p, const char* end, const char* keyword) {
+    size_t length = strlen(keyword);
+    return p + length < end && memcmp(p, keyword, length) == 0 && (p[length] == ' ' || p[length] == '\t');
+}
+
+std::string ObjName(const char* p, const char* end) {
+    p = ObjSkipSpaces(p, end);
+    while (end > p && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) {
+        end--;
+    }
+    return std::string(p, end);
+}
+
+const char* ObjParseFloat(const char* p, const char* end, float& value) {
+    p = ObjSkipSpaces(p, end);
+    if (p < end && *p == '+') {
+        p++;
+    }
+    auto result = std::from_chars(p, end, value);
+    if (result.ec != std::errc()) {
+        value = 0.0f;
+        return p;
+    }
+    return result.ptr;
+}
+
+// converts 1-based or negative relative indices into absolute 0-based ones
+const char* ObjParseIndex(const char* p, const char* end, u32 count, i32& index) {
+    bool negative = p < end && *p == '-';
+    if (negative) {
+        p++;
+    }
+    const char* start = p;
+    i64 value = 0;
+    while (p < end && *p >= '0' && *p <= '9') {
+        value = value * 10 + (*p - '0');
+        p++;
+    }
+    if (p == start || value == 0) {
+        index = -1;
+    } else {
+        index = negative ? i32(i64(count) - value) : i32(value - 1);
+    }
+    return p;
+}
+
+void ObjCountChunk(ObjChunk& chunk) {
+    for (const char* line = chunk.begin; line < chunk.end; line = ObjLineEnd(line, chunk.end) + 1) {
+        const char* p = ObjSkipSpaces(line, chunk.end);
+        if (p + 2 < chunk.end && p[0] == 'v') {
+            if (p[1] == ' ' || p[1] == '\t') {
+                chunk.positionCount++;
+            } else if (p[1] == 'n' && (p[2] == ' ' || p[2] == '\t')) {
+                chunk.normalCount++;
+            } else if (p[1] == 't' && (p[2] == ' ' || p[2] == '\t')) {
+                chunk.texCoordCount++;
+            }
+        }
+    }
+}
+
+void ObjParseChunk(ObjChunk& chunk, std::vector<glm::vec3>& positions, std::vector<glm::vec3>& normals, std::vector<glm::vec2>& texCoords) {
+    u32 positionCount = chunk.firstPosition;
+    u32 normalCount = chunk.firstNormal;
+    u32 texCoordCount = chunk.firstTexCoord;
+    std::vector<glm::ivec3> polygon;
+    for (const char* line = chunk.begin; line < chunk.end;) {
+        const char* lineEnd = ObjLineEnd(line, chunk.end);
+        const char* p = ObjSkipSpaces(line, lineEnd);
+        line = lineEnd + 1;
+        if (p + 1 >= lineEnd) {
+            continue;
+        }
+        if (p[0] == 'v' && (p[1] == ' ' || p[1] == '\t')) {
+            glm::vec3& v = positions[positionCount++];
+            p = ObjParseFloat(p + 1, lineEnd, v.x);
+            p = ObjParseFloat(p, lineEnd, v.y);
+            p = ObjParseFloat(p, lineEnd, v.z);
+        } else if (ObjKeyword(p, lineEnd, "vn")) {
+            glm::vec3& n = normals[normalCount++];
+            p = ObjParseFloat(p + 2, lineEnd, n.x);
+            p = ObjParseFloat(p, lineEnd, n.y);
+            p = ObjParseFloat(p, lineEnd, n.z);
+        } else if (ObjKeyword(p, lineEnd, "vt")) {
+            glm::vec2& uv = texCoords[texCoordCount++];
+            p = ObjParseFloat(p + 2, lineEnd, uv.x);
+            p = ObjParseFloat(p, lineEnd, uv.y);
+            uv.y = 1.0f - uv.y;
+        } else if (p[0] == 'f' && (p[1] == ' ' || p[1] == '\t')) {
+            polygon.clear();
+            p++;
+            while (true) {
+                p = ObjSkipSpaces(p, lineEnd);
+                if (p >= lineEnd || *p == '\r' || *p == '#') {
+                    break;
+                }
+                const char* start = p;
+                glm::ivec3 corner(-1);
+                p = ObjParseIndex(p, lineEnd, positionCount, corner.x);
+                if (p < lineEnd && *p == '/') {
+                    p++;
+                    if (p < lineEnd && *p != '/') {
+                        p = ObjParseIndex(p, lineEnd, texCoordCount, corner.y);
+                    }
+                    if (p < lineEnd && *p == '/') {
+                        p = ObjParseIndex(p + 1, lineEnd, normalCount, corner.z);
+                    }
+                }
+                if (p == start) {
+                    break;
+                }
+                polygon.push_back(corner);
+            }
+            for (size_t i = 2; i < polygon.size(); i++) {
+                chunk.corners.push_back(polygon[0]);
+                chunk.corners.push_back(polygon[i - 1]);
+                chunk.corners.push_back(polygon[i]);
+            }
+        } else if ((p[0] == 'o' || p[0] == 'g') && (p[1] == ' ' || p[1] == '\t')) {
+            chunk.runs.push_back({ u32(chunk.corners.size()), ObjName(p + 1, lineEnd), false });
+        } else if (ObjKeyword(p, lineEnd, "usemtl")) {
+            chunk.runs.push_back({ u32(chunk.corners.size()), ObjName(p + 6, lineEnd), true });
+        } else if (ObjKeyword(p, lineEnd, "mtllib")) {
+            chunk.mtllibs.push_back(ObjName(p + 6, lineEnd));
+        }
+    }
+}
+
+UUID ImportSceneOBJ(const std::filesystem::path& path, AssetManager& manager, const ImportSettings& settings, ImportProgress* progress, ImportReport& report) {
     DEBUG_TRACE("Start loading mesh {}", path.string().c_str());
-    tinyobj::attrib_t attrib;
-    std::vector<tinyobj::shape_t> shapes;
-    std::vector<tinyobj::material_t> materials;
-    std::string err;
-    std::string warn;
     std::string filename = path.stem().string();
     std::string parentPath = path.parent_path().string() + "/";
 
-    if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, path.string().c_str(), parentPath.c_str(), true)) {
-        LOG_ERROR("{}", err);
-        LOG_WARN("{}", warn);
+    StageTimer timer{ report, ImportReport::Parse };
+    Ref<MappedFile> file = MapFile(path);
+    if (!file) {
         LOG_ERROR("Failed to load obj file {}", path.string().c_str());
+        return 0;
     }
+    report.bytesRead += file->size;
 
-    if (warn != "") {
-        LOG_WARN("Warning during load obj file {}: {}", path.string().c_str(), warn);
+    // split at line boundaries, count vertex attributes per chunk to know where each chunk writes
+    const size_t chunkSize = 4 * 1024 * 1024;
+    const char* text = (const char*)file->data;
+    const char* textEnd = text + file->size;
+    std::vector<ObjChunk> chunks;
+    for (const char* p = text; p < textEnd;) {
+        ObjChunk& chunk = chunks.emplace_back();
+        chunk.begin = p;
+        chunk.end = std::min(p + chunkSize, textEnd);
+        chunk.end = chunk.end < textEnd ? ObjLineEnd(chunk.end, textEnd) : textEnd;
+        p = chunk.end < textEnd ? chunk.end + 1 : textEnd;
+    }
+    ThreadPool::ParallelFor(u32(chunks.size()), [&](u32 i) {
+        ObjCountChunk(chunks[i]);
+    });
+    u32 positionCount = 0;
+    u32 normalCount = 0;
+    u32 texCoordCount = 0;
+    for (ObjChunk& chunk : chunks) {
+        chunk.firstPosition = positionCount;
+        chunk.firstNormal = normalCount;
+        chunk.firstTexCoord = texCoordCount;
+        positionCount += chunk.positionCount;
+        normalCount += chunk.normalCount;
+        texCoordCount += chunk.texCoordCount;
+    }
+    std::vector<glm::vec3> positions(positionCount);
+    std::vector<glm::vec3> normals(normalCount);
+    std::vector<glm::vec2> texCoords(texCoordCount);
+    ThreadPool::ParallelFor(u32(chunks.size()), [&](u32 i) {
+        ObjParseChunk(chunks[i], positions, normals, texCoords);
+    });
+
+    if (NextStep(progress)) {
+        return 0;
+    }
+
+    // materials
+    std::vector<tinyobj::material_t> materials;
+    std::map<std::string, int> materialIndices;
+    for (const ObjChunk& chunk : chunks) {
+        for (const std::string& mtllib : chunk.mtllibs) {
+            std::ifstream stream(parentPath + mtllib);
+            if (!stream) {
+                LOG_WARN("Material library {} not found for obj file {}", mtllib, path.string().c_str());
+                continue;
+            }
+            report.bytesRead += FileSize(parentPath + mtllib);
+            std::string err;
+            std::string warn;
+            tinyobj::LoadMtl(&materialIndices, &materials, &stream, &warn, &err);
+            if (warn != "") {
+                LOG_WARN("Warning during load mtl file {}: {}", mtllib, warn);
+            }
+            if (err != "") {
+                LOG_ERROR("{}", err);
+            }
+        }
     }
 
     // convert obj material to my material
+    timer.Next(ImportReport::Scene);
     auto avg = [](const tinyobj::real_t value[3]) {return (value[0] + value[1] + value[2]) / 3.0f; };
     std::vector<Ref<MaterialAsset>> materialAssets;
     std::unordered_map<std::string, Ref<TextureAsset>> textureAssets;
     for (size_t i = 0; i < materials.size(); i++) {
         Ref<MaterialAsset> asset = manager.CreateAsset<MaterialAsset>(filename + ":" + materials[i].name);
-        //asset->color = glm::vec4(1, 0, 0, 1);
         asset->color = glm::vec4(glm::make_vec3(materials[i].diffuse), 1);
         asset->emission = glm::make_vec3(materials[i].emission);
         asset->metallic = materials[i].metallic;
@@ -437,93 +1498,611 @@ UUID ImportSceneOBJ(const std::filesystem::path& path, AssetManager& manager) {
         } else {
             asset->roughness = materials[i].roughness;
         }
-        if (materials[i].diffuse_texname != "") {
-            if (textureAssets.find(materials[i].diffuse_texname) == textureAssets.end()) {
-                asset->colorMap = manager.CreateAsset<TextureAsset>(materials[i].diffuse_texname);
-                ImportTexture(parentPath + materials[i].diffuse_texname, asset->colorMap);
-                textureAssets[materials[i].diffuse_texname] = asset->colorMap;
-            } else {
-                asset->colorMap = textureAssets[materials[i].diffuse_texname];
+        auto getTexture = [&](const std::string& texname) {
+            auto it = textureAssets.find(texname);
+            if (it != textureAssets.end()) {
+                return it->second;
             }
+            return textureAssets[texname] = manager.CreateAsset<TextureAsset>(texname);
+        };
+        if (materials[i].diffuse_texname != "") {
+            asset->colorMap = getTexture(materials[i].diffuse_texname);
         }
         if (materials[i].normal_texname != "") {
-            if (textureAssets.find(materials[i].normal_texname) == textureAssets.end()) {
-                asset->normalMap = manager.CreateAsset<TextureAsset>(materials[i].normal_texname);
-                ImportTexture(parentPath + materials[i].normal_texname, asset->normalMap);
-                textureAssets[materials[i].normal_texname] = asset->normalMap;
-            } else {
-                asset->normalMap = textureAssets[materials[i].normal_texname];
-            }
+            asset->normalMap = getTexture(materials[i].normal_texname);
+            AssignContent(*asset->normalMap, TextureAsset::Content::Normal);
         }
         materialAssets.push_back(asset);
     }
+    std::vector<std::pair<std::string, Ref<TextureAsset>>> pendingTextures(textureAssets.begin(), textureAssets.end());
+    std::vector<u8> nativeTextures(pendingTextures.size(), 0);
+    timer.Next(ImportReport::TextureDecode);
+    ThreadPool::ParallelFor((u32)pendingTextures.size(), [&](u32 i) {
+        nativeTextures[i] = ImportTexture(parentPath + pendingTextures[i].first, pendingTextures[i].second);
+    });
+    timer.Stop();
+    std::vector<Ref<TextureAsset>> textures;
+    for (u32 i = 0; i < pendingTextures.size(); i++) {
+        u64 size = FileSize(parentPath + pendingTextures[i].first);
+        report.bytesRead += size;
+        report.textures++;
+        report.textureBytesRead += size;
+        report.textureBytesDecoded += pendingTextures[i].second->data.size();
+        if (!nativeTextures[i]) {
+            textures.push_back(pendingTextures[i].second);
+        }
+    }
+    ProcessTextures(textures, settings, report);
+    if (NextStep(progress)) {
+        return 0;
+    }
+
+    // resolve object and material state across chunks into one mesh per run
+    timer.Next(ImportReport::Geometry);
+    std::vector<ObjMesh> meshes;
+    std::string object = filename;
+    std::string material = "";
+    auto addSegment = [&](u32 chunk, u32 begin, u32 end) {
+        if (begin == end) {
+            return;
+        }
+        if (meshes.empty() || meshes.back().object != object || meshes.back().material != material) {
+            meshes.push_back({ object, material });
+        }
+        meshes.back().segments.push_back({ chunk, begin, end });
+        meshes.back().cornerCount += end - begin;
+    };
+    for (u32 c = 0; c < chunks.size(); c++) {
+        u32 begin = 0;
+        for (const ObjRun& run : chunks[c].runs) {
+            addSegment(c, begin, run.firstCorner);
+            begin = run.firstCorner;
+            (run.isMaterial ? material : object) = run.name;
+        }
+        addSegment(c, begin, u32(chunks[c].corners.size()));
+    }
+    for (const ObjMesh& mesh : meshes) {
+        report.verticesRead += mesh.cornerCount;
+    }
 
     Ref<SceneAsset> scene = manager.CreateAsset<SceneAsset>(filename);
     Ref<Node> parentNode = manager.CreateObject<Node>(filename);
     scene->Add(parentNode);
-    for (size_t i = 0; i < shapes.size(); i++) {
-        if (shapes[i].mesh.indices.size() == 0) {
-            continue;
+    std::unordered_map<std::string, int> objectSplits;
+    for (ObjMesh& mesh : meshes) {
+        std::string name = filename + ":" + mesh.object + "_" + std::to_string(objectSplits[mesh.object]++);
+        mesh.asset = manager.CreateAsset<MeshAsset>(name);
+        Ref<MeshNode> model = manager.CreateObject<MeshNode>(name);
+        Node::SetParent(model, parentNode);
+        model->mesh = mesh.asset;
+        model->isStatic = true;
+        auto it = materialIndices.find(mesh.material);
+        if (it != materialIndices.end()) {
+            model->material = materialAssets[it->second];
         }
-        std::unordered_map<MeshAsset::MeshVertex, uint32_t> uniqueVertices{};
-        int splittedShapeIndex = 0;
-        size_t j = 0;
-        size_t lastMaterialId = shapes[i].mesh.material_ids.size() > 0 ? shapes[i].mesh.material_ids[0] : -1;
-        Ref<MeshAsset> asset = manager.CreateAsset<MeshAsset>(filename + ":" + shapes[i].name);
-        for (const auto& index : shapes[i].mesh.indices) {
-            MeshAsset::MeshVertex vertex{};
-
-            vertex.position = {
-                attrib.vertices[3 * index.vertex_index + 0],
-                attrib.vertices[3 * index.vertex_index + 1],
-                attrib.vertices[3 * index.vertex_index + 2]
-            };
+    }
 
-            if (index.normal_index != -1) {
-                vertex.normal = {
-                    attrib.normals[3 * index.normal_index + 0],
-                    attrib.normals[3 * index.normal_index + 1],
-                    attrib.normals[3 * index.normal_index + 2],
-                };
+    ThreadPool::ParallelFor(u32(meshes.size()), [&](u32 m) {
+        MeshAsset& asset = *meshes[m].asset;
+        MeshProcessing::VertexTable table(meshes[m].cornerCount / 4);
+        asset.indices.reserve(meshes[m].cornerCount);
+        for (const ObjSegment& segment : meshes[m].segments) {
+            const std::vector<glm::ivec3>& corners = chunks[segment.chunk].corners;
+            for (u32 i = segment.begin; i + 2 < segment.end; i += 3) {
+                bool valid = true;
+                for (u32 k = 0; k < 3; k++) {
+                    valid &= corners[i + k].x >= 0 && corners[i + k].x < i32(positionCount);
+                }
+                if (!valid) {
+                    continue;
+                }
+                for (u32 k = 0; k < 3; k++) {
+                    const glm::ivec3& corner = corners[i + k];
+                    MeshAsset::MeshVertex vertex{};
+                    vertex.position = positions[corner.x];
+                    if (corner.y >= 0 && corner.y < i32(texCoordCount)) {
+                        vertex.texCoord = texCoords[corner.y];
+                    }
+                    if (corner.z >= 0 && corner.z < i32(normalCount)) {
+                        vertex.normal = normals[corner.z];
+                    }
+                    asset.indices.push_back(table.Insert(vertex, asset.vertices));
+                }
+            }
+        }
+    });
+
+    std::vector<Ref<MeshAsset>> meshAssets;
+    for (ObjMesh& mesh : meshes) {
+        meshAssets.push_back(mesh.asset);
+    }
+    timer.Stop();
+    if (NextStep(progress)) {
+        return 0;
+    }
+    ProcessMeshes(meshAssets, settings, report);
+
+    Log::Info("Objects: %d", parentNode->children.size());
+    return scene->uuid;
+}
+
+// binary ply, the header lists the elements in file order and every record stores its properties in order
+enum class PlyType : u8 {
+    None,
+    I8,
+    U8,
+    I16,
+    U16,
+    I32,
+    U32,
+    F32,
+    F64,
+};
+
+static u32 PlyTypeSize(PlyType type) {
+    static constexpr u32 sizes[] = { 0, 1, 1, 2, 2, 4, 4, 4, 8 };
+    return sizes[u32(type)];
+}
+
+static PlyType ParsePlyType(const std::string& name) {
+    static const std::pair<const char*, PlyType> types[] = {
+        { "char", PlyType::I8 }, { "int8", PlyType::I8 }, { "uchar", PlyType::U8 }, { "uint8", PlyType::U8 },
+        { "short", PlyType::I16 }, { "int16", PlyType::I16 }, { "ushort", PlyType::U16 }, { "uint16", PlyType::U16 },
+        { "int", PlyType::I32 }, { "int32", PlyType::I32 }, { "uint", PlyType::U32 }, { "uint32", PlyType::U32 },
+        { "float", PlyType::F32 }, { "float32", PlyType::F32 }, { "double", PlyType::F64 }, { "float64", PlyType::F64 },
+    };
+    for (const auto& [typeName, type] : types) {
+        if (name == typeName) {
+            return type;
+        }
+    }
+    return PlyType::None;
+}
+
+struct PlyProperty {
+    std::string name;
+    PlyType type = PlyType::None;
+    // list properties store a count of countType followed by that many values of type
+    PlyType countType = PlyType::None;
+    // offset inside the record, for properties before the first list
+    u32 offset = 0;
+};
+
+struct PlyElement {
+    std::string name;
+    u64 count = 0;
+    std::vector<PlyProperty> properties;
+    // record size, 0 when a list makes records variable
+    u32 stride = 0;
+    const u8* data = nullptr;
+
+    const PlyProperty* Find(std::initializer_list<const char*> names) const {
+        for (const PlyProperty& property : properties) {
+            for (const char* name : names) {
+                if (property.name == name) {
+                    return &property;
+                }
             }
+        }
+        return nullptr;
+    }
+};
+
+struct PlyHeader {
+    bool bigEndian = false;
+    std::vector<PlyElement> elements;
+    const u8* data = nullptr;
+};
+
+template<typename T>
+static T LoadPly(const u8* p, bool bigEndian) {
+    u8 bytes[sizeof(T)];
+    for (size_t i = 0; i < sizeof(T); i++) {
+        bytes[i] = bigEndian ? p[sizeof(T) - 1 - i] : p[i];
+    }
+    T value;
+    memcpy(&value, bytes, sizeof(T));
+    return value;
+}
+
+static double ReadPly(const u8* p, PlyType type, bool bigEndian) {
+    switch (type) {
+    case PlyType::I8: return LoadPly<i8>(p, bigEndian);
+    case PlyType::U8: return LoadPly<u8>(p, bigEndian);
+    case PlyType::I16: return LoadPly<i16>(p, bigEndian);
+    case PlyType::U16: return LoadPly<u16>(p, bigEndian);
+    case PlyType::I32: return LoadPly<i32>(p, bigEndian);
+    case PlyType::U32: return LoadPly<u32>(p, bigEndian);
+    case PlyType::F32: return LoadPly<float>(p, bigEndian);
+    case PlyType::F64: return LoadPly<double>(p, bigEndian);
+    default: return 0.0;
+    }
+}
 
-            if (index.texcoord_index == -1) {
-                vertex.texCoord = { 0, 0 };
+static i64 ReadPlyInteger(const u8* p, PlyType type, bool bigEndian) {
+    switch (type) {
+    case PlyType::I8: return LoadPly<i8>(p, bigEndian);
+    case PlyType::U8: return LoadPly<u8>(p, bigEndian);
+    case PlyType::I16: return LoadPly<i16>(p, bigEndian);
+    case PlyType::U16: return LoadPly<u16>(p, bigEndian);
+    case PlyType::I32: return LoadPly<i32>(p, bigEndian);
+    case PlyType::U32: return LoadPly<u32>(p, bigEndian);
+    default: return -1;
+    }
+}
+
+static bool ParsePlyHeader(const u8* data, size_t size, PlyHeader& header) {
+    std::string_view text((const char*)data, std::min<size_t>(size, 1 << 20));
+    size_t headerEnd = text.find("end_header");
+    size_t dataBegin = headerEnd != std::string_view::npos ? text.find('\n', headerEnd) : std::string_view::npos;
+    if (text.substr(0, 3) != "ply" || dataBegin == std::string_view::npos) {
+        LOG_ERROR("Not a ply file");
+        return false;
+    }
+    header.data = data + dataBegin + 1;
+    std::istringstream lines(std::string(text.substr(0, headerEnd)));
+    std::string line;
+    while (std::getline(lines, line)) {
+        std::istringstream tokens(line);
+        std::string keyword;
+        tokens >> keyword;
+        if (keyword == "format") {
+            std::string format;
+            tokens >> format;
+            if (format != "binary_little_endian" && format != "binary_big_endian") {
+                LOG_ERROR("Unsupported ply format {}, only binary files are read", format);
+                return false;
             }
-            else {
-                vertex.texCoord = {
-                    attrib.texcoords[2 * index.texcoord_index + 0],
-                    1.0f - attrib.texcoords[2 * index.texcoord_index + 1]
-                };
+            header.bigEndian = format == "binary_big_endian";
+        } else if (keyword == "element") {
+            PlyElement& element = header.elements.emplace_back();
+            tokens >> element.name >> element.count;
+        } else if (keyword == "property") {
+            if (header.elements.empty()) {
+                LOG_ERROR("Ply property outside of an element");
+                return false;
+            }
+            PlyProperty& property = header.elements.back().properties.emplace_back();
+            std::string type;
+            tokens >> type;
+            if (type == "list") {
+                std::string countType;
+                tokens >> countType >> type;
+                property.countType = ParsePlyType(countType);
+                if (property.countType == PlyType::None || property.countType == PlyType::F32 || property.countType == PlyType::F64) {
+                    LOG_ERROR("Unsupported ply list count type {}", countType);
+                    return false;
+                }
+            }
+            property.type = ParsePlyType(type);
+            tokens >> property.name;
+            if (property.type == PlyType::None) {
+                LOG_ERROR("Unsupported ply property type {}", type);
+                return false;
+            }
+        }
+    }
+    for (PlyElement& element : header.elements) {
+        u32 offset = 0;
+        bool fixed = true;
+        for (PlyProperty& property : element.properties) {
+            property.offset = offset;
+            fixed &= property.countType == PlyType::None;
+            offset += fixed ? PlyTypeSize(property.type) : 0;
+        }
+        element.stride = fixed ? offset : 0;
+    }
+    return true;
+}
+
+// the end of a variable size record, nullptr when it runs past the end of the file
+static const u8* SkipPlyRecord(const u8* p, const u8* end, const PlyElement& element, bool bigEndian) {
+    for (const PlyProperty& property : element.properties) {
+        if (property.countType != PlyType::None) {
+            if (p + PlyTypeSize(property.countType) > end) {
+                return nullptr;
+            }
+            i64 count = ReadPlyInteger(p, property.countType, bigEndian);
+            p += PlyTypeSize(property.countType) + std::max<i64>(count, 0) * PlyTypeSize(property.type);
+        } else {
+            p += PlyTypeSize(property.type);
+        }
+        if (p > end) {
+            return nullptr;
+        }
+    }
+    return p;
+}
+
+// start of a list property inside a record, SkipPlyRecord has to have validated the record
+static const u8* FindPlyList(const u8* p, const PlyElement& element, const PlyProperty& list, bool bigEndian) {
+    for (const PlyProperty& property : element.properties) {
+        if (&property == &list) {
+            break;
+        }
+        if (property.countType != PlyType::None) {
+            p += PlyTypeSize(property.countType) + std::max<i64>(ReadPlyInteger(p, property.countType, bigEndian), 0) * PlyTypeSize(property.type);
+        } else {
+            p += PlyTypeSize(property.type);
+        }
+    }
+    return p;
+}
+
+// records of every element until the ones that are needed, fixed size elements are skipped at once
+static bool LocatePlyElements(PlyHeader& header, const u8* end, std::initializer_list<const char*> needed) {
+    const u8* p = header.data;
+    u32 remaining = u32(needed.size());
+    for (PlyElement& element : header.elements) {
+        if (remaining == 0) {
+            break;
+        }
+        element.data = p;
+        for (const char* name : needed) {
+            remaining -= element.name == name;
+        }
+        if (element.stride > 0) {
+            if (element.count > u64(end - p) / element.stride) {
+                return false;
+            }
+            p += element.count * element.stride;
+        } else if (remaining > 0) {
+            for (u64 i = 0; i < element.count && p; i++) {
+                p = SkipPlyRecord(p, end, element, header.bigEndian);
+            }
+            if (!p) {
+                return false;
             }
+        }
+    }
+    return true;
+}
+
+struct PlyFaceChunk {
+    const u8* begin = nullptr;
+    u64 firstFace = 0;
+    u64 faceCount = 0;
+    u64 firstTriangle = 0;
+    u64 triangleCount = 0;
+    u64 invalid = 0;
+};
+
+// polygons are triangulated as fans, triangles referencing missing vertices are written as ~0u
+static void DecodePlyFaces(const PlyElement& faces, const PlyProperty& list, bool bigEndian, const u8* end, u32 vertexCount, PlyFaceChunk& chunk, std::vector<u32>& indices) {
+    const u8* p = chunk.begin;
+    u32 countSize = PlyTypeSize(list.countType);
+    u32 indexSize = PlyTypeSize(list.type);
+    u32* out = indices.data() + chunk.firstTriangle * 3;
+    for (u64 f = 0; f < chunk.faceCount; f++) {
+        const u8* corners = FindPlyList(p, faces, list, bigEndian);
+        p = SkipPlyRecord(p, end, faces, bigEndian);
+        i64 count = ReadPlyInteger(corners, list.countType, bigEndian);
+        corners += countSize;
+        const auto corner = [&](i64 k) {
+            i64 index = ReadPlyInteger(corners + k * indexSize, list.type, bigEndian);
+            return index >= 0 && index < vertexCount ? u32(index) : ~0u;
+        };
+        for (i64 k = 1; k + 1 < count; k++) {
+            u32 a = corner(0);
+            u32 b = corner(k);
+            u32 c = corner(k + 1);
+            bool valid = a != ~0u && b != ~0u && c != ~0u;
+            chunk.invalid += !valid;
+            *out++ = valid ? a : ~0u;
+            *out++ = valid ? b : ~0u;
+            *out++ = valid ? c : ~0u;
+        }
+    }
+}
 
-            if (uniqueVertices.count(vertex) == 0) {
-                uniqueVertices[vertex] = (uint32_t)(asset->vertices.size());
-                asset->vertices.push_back(vertex);
+UUID ImportScenePLY(const std::filesystem::path& path, AssetManager& manager, const ImportSettings& settings, ImportProgress* progress, ImportReport& report) {
+    std::string filename = path.stem().string();
+    StageTimer timer{ report, ImportReport::Parse };
+    Ref<MappedFile> file = MapFile(path);
+    PlyHeader header;
+    if (!file || !ParsePlyHeader(file->data, file->size, header)) {
+        LOG_ERROR("Failed to load ply file {}", path.string());
+        return 0;
+    }
+    report.bytesRead += file->size;
+    const u8* end = file->data + file->size;
+    auto findElement = [&](const char* name) -> PlyElement* {
+        for (PlyElement& element : header.elements) {
+            if (element.name == name) {
+                return &element;
             }
+        }
+        return nullptr;
+    };
+    PlyElement* vertices = findElement("vertex");
+    PlyElement* faces = findElement("face");
+    const PlyProperty* list = faces ? faces->Find({ "vertex_indices", "vertex_index" }) : nullptr;
+    if (!vertices || !faces || faces->count == 0 || !list || list->countType == PlyType::None) {
+        LOG_ERROR("Ply file {} has no faces, point clouds can't be rendered", path.string());
+        return 0;
+    }
+    if (vertices->stride == 0 || vertices->count >= ~0u) {
+        LOG_ERROR("Unsupported vertex layout in ply file {}", path.string());
+        return 0;
+    }
+    if (!LocatePlyElements(header, end, { "vertex", "face" })) {
+        LOG_ERROR("Ply file {} is truncated", path.string());
+        return 0;
+    }
+    const bool bigEndian = header.bigEndian;
+    const u32 vertexCount = u32(vertices->count);
+
+    const PlyProperty* position[3] = { vertices->Find({ "x" }), vertices->Find({ "y" }), vertices->Find({ "z" }) };
+    const PlyProperty* normal[3] = { vertices->Find({ "nx" }), vertices->Find({ "ny" }), vertices->Find({ "nz" }) };
+    const PlyProperty* texCoord[2] = { vertices->Find({ "u", "s", "texture_u", "texture_s" }), vertices->Find({ "v", "t", "texture_v", "texture_t" }) };
+    if (!position[0] || !position[1] || !position[2]) {
+        LOG_ERROR("Ply file {} has no vertex positions", path.string());
+        return 0;
+    }
+    const bool hasNormals = normal[0] && normal[1] && normal[2];
+    const bool hasTexCoords = texCoord[0] && texCoord[1];
 
-            asset->indices.push_back(uniqueVertices[vertex]);
-            j += 1;
+    // positions of every vertex are kept for splitting, the other attributes are read from the mapping when a
+    // vertex is first used by a part
+    const u32 chunkSize = 1 << 16;
+    std::vector<glm::vec3> positions(vertexCount);
+    ThreadPool::ParallelFor((vertexCount + chunkSize - 1) / chunkSize, [&](u32 c) {
+        u32 last = std::min(vertexCount, (c + 1) * chunkSize);
+        for (u32 v = c * chunkSize; v < last; v++) {
+            const u8* record = vertices->data + u64(v) * vertices->stride;
+            for (int k = 0; k < 3; k++) {
+                positions[v][k] = float(ReadPly(record + position[k]->offset, position[k]->type, bigEndian));
+            }
+        }
+    });
 
-            if (j % 3 == 0) {
-                size_t faceId = j / 3;
-                if (faceId >= shapes[i].mesh.material_ids.size() || shapes[i].mesh.material_ids[faceId] != lastMaterialId) {
-                    asset->name += "_" + std::to_string(splittedShapeIndex);
-                    Ref<MeshNode> model = manager.CreateObject<MeshNode>(asset->name);
-                    Node::SetParent(model, parentNode);
-                    model->mesh = asset;
-                    if (lastMaterialId != -1) {
-                        model->material = materialAssets[lastMaterialId];
+    // scans usually hold only triangles, a fixed face size is verified in parallel before scanning for polygons
+    std::vector<PlyFaceChunk> chunks;
+    u32 countSize = PlyTypeSize(list->countType);
+    u32 indexSize = PlyTypeSize(list->type);
+    u64 triangleStride = 0;
+    bool onlyTriangles = true;
+    for (const PlyProperty& property : faces->properties) {
+        onlyTriangles &= &property == list || property.countType == PlyType::None;
+        triangleStride += &property == list ? countSize + 3 * indexSize : PlyTypeSize(property.type);
+    }
+    onlyTriangles &= faces->count <= u64(end - faces->data) / triangleStride;
+    if (onlyTriangles) {
+        for (u64 first = 0; first < faces->count; first += chunkSize) {
+            PlyFaceChunk& chunk = chunks.emplace_back();
+            chunk.begin = faces->data + first * triangleStride;
+            chunk.firstFace = chunk.firstTriangle = first;
+            chunk.faceCount = chunk.triangleCount = std::min<u64>(chunkSize, faces->count - first);
+        }
+        std::vector<u8> triangleChunks(chunks.size(), 1);
+        ThreadPool::ParallelFor(u32(chunks.size()), [&](u32 c) {
+            for (u64 f = 0; f < chunks[c].faceCount && triangleChunks[c]; f++) {
+                const u8* record = chunks[c].begin + f * triangleStride;
+                triangleChunks[c] = ReadPlyInteger(record + list->offset, list->countType, bigEndian) == 3;
+            }
+        });
+        onlyTriangles = std::find(triangleChunks.begin(), triangleChunks.end(), 0) == triangleChunks.end();
+    }
+    if (!onlyTriangles) {
+        chunks.clear();
+        const u8* p = faces->data;
+        u64 triangleCount = 0;
+        for (u64 first = 0; first < faces->count && p; first += chunkSize) {
+            PlyFaceChunk& chunk = chunks.emplace_back();
+            chunk.begin = p;
+            chunk.firstFace = first;
+            chunk.faceCount = std::min<u64>(chunkSize, faces->count - first);
+            chunk.firstTriangle = triangleCount;
+            for (u64 f = 0; f < chunk.faceCount && p; f++) {
+                const u8* record = p;
+                p = SkipPlyRecord(p, end, *faces, bigEndian);
+                if (p) {
+                    const u8* corners = FindPlyList(record, *faces, *list, bigEndian);
+                    chunk.triangleCount += std::max<i64>(ReadPlyInteger(corners, list->countType, bigEndian) - 2, 0);
+                }
+            }
+            triangleCount += chunk.triangleCount;
+        }
+        if (!p) {
+            LOG_ERROR("Ply file {} is truncated", path.string());
+            return 0;
+        }
+    }
+    u64 triangleCount = chunks.back().firstTriangle + chunks.back().triangleCount;
+    if (triangleCount * 3 >= ~0u) {
+        LOG_ERROR("Ply file {} has too many triangles", path.string());
+        return 0;
+    }
+    std::vector<u32> indices(triangleCount * 3);
+    ThreadPool::ParallelFor(u32(chunks.size()), [&](u32 c) {
+        DecodePlyFaces(*faces, *list, bigEndian, end, vertexCount, chunks[c], indices);
+    });
+    u64 invalid = 0;
+    for (const PlyFaceChunk& chunk : chunks) {
+        invalid += chunk.invalid;
+    }
+    if (invalid > 0) {
+        LOG_WARN("Dropped {} triangles with missing vertices from {}", invalid, path.string());
+        indices.erase(std::remove(indices.begin(), indices.end(), ~0u), indices.end());
+    }
+
+    if (NextStep(progress)) {
+        return 0;
+    }
+    if (NextStep(progress)) {
+        return 0;
+    }
+
+    timer.Next(ImportReport::Geometry);
+    report.verticesRead += vertexCount;
+    std::vector<u32> triangles;
+    u32 maxTriangles = settings.splitLargeMeshes ? settings.maxMeshTriangles : ~0u;
+    std::vector<u32> parts = MeshProcessing::SplitSpatially(positions, indices, maxTriangles, triangles);
+    u32 partCount = u32(parts.size() - 1);
+
+    Ref<SceneAsset> scene = manager.CreateAsset<SceneAsset>(filename);
+    Ref<Node> parentNode = manager.CreateObject<Node>(filename);
+    scene->Add(parentNode);
+    std::vector<Ref<MeshAsset>> meshes(partCount);
+    for (u32 i = 0; i < partCount; i++) {
+        std::string name = partCount > 1 ? filename + ":part_" + std::to_string(i) : filename;
+        meshes[i] = manager.CreateAsset<MeshAsset>(name);
+        Ref<MeshNode> model = manager.CreateObject<MeshNode>(name);
+        Node::SetParent(model, parentNode);
+        model->mesh = meshes[i];
+        model->isStatic = true;
+    }
+    ThreadPool::ParallelFor(partCount, [&](u32 i) {
+        MeshAsset& mesh = *meshes[i];
+        u32 first = parts[i];
+        u32 count = parts[i + 1] - first;
+        // file vertex to part vertex, open addressing with room for every corner. vertices are added in the
+        // order they are first used, which keeps fetches local
+        u32 capacity = 64;
+        while (capacity < count * 4) {
+            capacity *= 2;
+        }
+        std::vector<u32> keys(capacity, ~0u);
+        std::vector<u32> values(capacity);
+        mesh.indices.resize(count * 3);
+        for (u32 t = 0; t < count; t++) {
+            u32 triangle = triangles[first + t];
+            for (u32 k = 0; k < 3; k++) {
+                u32 v = indices[triangle * 3 + k];
+                u32 slot = (v * 2654435761u) & (capacity - 1);
+                while (keys[slot] != ~0u && keys[slot] != v) {
+                    slot = (slot + 1) & (capacity - 1);
+                }
+                if (keys[slot] == ~0u) {
+                    keys[slot] = v;
+                    values[slot] = u32(mesh.vertices.size());
+                    const u8* record = vertices->data + u64(v) * vertices->stride;
+                    MeshAsset::MeshVertex& vertex = mesh.vertices.emplace_back();
+                    vertex = {};
+                    vertex.position = positions[v];
+                    for (int c = 0; c < 3 && hasNormals; c++) {
+                        vertex.normal[c] = float(ReadPly(record + normal[c]->offset, normal[c]->type, bigEndian));
                     }
-                    if (faceId < shapes[i].mesh.material_ids.size()) {
-                        lastMaterialId = shapes[i].mesh.material_ids[faceId];
+                    if (hasTexCoords) {
+                        vertex.texCoord.x = float(ReadPly(record + texCoord[0]->offset, texCoord[0]->type, bigEndian));
+                        vertex.texCoord.y = 1.0f - float(ReadPly(record + texCoord[1]->offset, texCoord[1]->type, bigEndian));
                     }
-                    uniqueVertices.clear();
                 }
+                mesh.indices[t * 3 + k] = values[slot];
             }
         }
+    });
+    LOG_INFO("Split {} triangles of {} into {} meshes", indices.size() / 3, path.string(), partCount);
+    // the decoded arrays are released before the meshes get processed
+    std::vector<glm::vec3>().swap(positions);
+    std::vector<u32>().swap(indices);
+    std::vector<u32>().swap(triangles);
+    timer.Stop();
+
+    if (NextStep(progress)) {
+        return 0;
     }
-    Log::Info("Objects: %d", parentNode->children.size());
+    ProcessMeshes(meshes, settings, report);
     return scene->uuid;
 }
 
@@ -1,19 +1,111 @@
 #pragma once
 
+#include <atomic>
 #include <filesystem>
 #include "Base.hpp"
 
 struct AssetManager;
 
 namespace AssetIO {
-    UUID Import(const std::filesystem::path& path, AssetManager& assets);
-    UUID ImportTexture(const std::filesystem::path& path, AssetManager& assets);
-    UUID ImportScene(const std::filesystem::path& path, AssetManager& assets);
+    // read only view of a whole file, unmapped on destruction
+    struct MappedFile {
+        const u8* data = nullptr;
+        size_t size = 0;
+        ~MappedFile();
+    };
+
+    struct ImportSettings {
+        // compute tangents for meshes imported without them
+        bool generateTangents = true;
+        // weld, drop degenerates and reorder for vertex cache, overdraw and fetch
+        bool optimizeMeshes = true;
+        // split meshes into small clusters with bounds for culling
+        bool buildMeshlets = true;
+        // append a simplified lod chain to each mesh
+        bool generateLods = true;
+        // upload meshes with the 20 byte packed vertex instead of the 48 byte one
+        bool packVertices = true;
+        // build the mip chain of every imported texture
+        bool generateMips = true;
+        // block compress textures with the format that suits their material slot
+        bool compressTextures = true;
+        // .ply scans above maxMeshTriangles are split spatially into several meshes, so no vertex buffer, index
+        // buffer or blas of a scan outgrows device limits
+        bool splitLargeMeshes = true;
+        u32 maxMeshTriangles = 1 << 21;
+    };
+
+    // shared with an import running on another thread, the importer counts the steps it finished
+    // and stops at the next step once cancel is set
+    struct ImportProgress {
+        std::atomic<u32> steps = 0;
+        std::atomic<bool> cancel = false;
+    };
+    // parse, textures, geometry and mesh processing
+    inline constexpr u32 ImportSteps = 4;
+
+    // where one import spent its time and how much data went through each stage, luz-import sums the reports
+    // of a batch. stage times are wall times of the importing thread, stages run their work in parallel
+    struct ImportReport {
+        enum Stage : u32 {
+            // reading and parsing the source file, external buffers and material libraries
+            Parse,
+            TextureDecode,
+            // mips and block compression
+            TextureProcess,
+            // vertex assembly and dedup into mesh assets
+            Geometry,
+            Tangents,
+            Optimize,
+            Lods,
+            Meshlets,
+            // materials, nodes and scenes
+            Scene,
+            StageCount,
+        };
+
+        std::string file;
+        bool failed = false;
+        double milliseconds = 0.0;
+        double stageMilliseconds[StageCount] = {};
+        // source files read, textures included
+        u64 bytesRead = 0;
+        u64 textures = 0;
+        // encoded image bytes and the pixels or container payload they decoded to, before mips
+        u64 textureBytesRead = 0;
+        u64 textureBytesDecoded = 0;
+        u64 meshes = 0;
+        // vertices referenced by the source (face corners for obj), left after dedup and after the optimizer welded them
+        u64 verticesRead = 0;
+        u64 verticesUnique = 0;
+        u64 verticesOptimized = 0;
+        u64 triangles = 0;
+        u64 lods = 0;
+        u64 meshlets = 0;
+        u64 assets = 0;
+
+        static const char* StageName(Stage stage);
+        ImportReport& operator+=(const ImportReport& rhs);
+        // single line json object
+        std::string ToJson() const;
+    };
+    // json object with every report and their sum, wallMilliseconds is the time the whole batch took
+    std::string ReportJson(const std::vector<ImportReport>& reports, double wallMilliseconds);
+
+    // identifies an import by the source file content and the settings, 0 if the file can't be read.
+    // files referenced by the source (gltf buffers, obj materials, textures) are not part of the key
+    u64 ImportKey(const std::filesystem::path& path, const ImportSettings& settings = {});
+    // returns 0 when the import failed or was cancelled
+    // logs the report of the import and fills report when given
+    UUID Import(const std::filesystem::path& path, AssetManager& assets, const ImportSettings& settings = {}, ImportProgress* progress = nullptr, ImportReport* report = nullptr);
+    UUID ImportTexture(const std::filesystem::path& path, AssetManager& assets, ImportReport* report = nullptr);
+    UUID ImportScene(const std::filesystem::path& path, AssetManager& assets, const ImportSettings& settings = {}, ImportProgress* progress = nullptr, ImportReport* report = nullptr);
     bool IsTexture(const std::filesystem::path& path);
     bool IsScene(const std::filesystem::path& path);
     void WriteFile(const std::filesystem::path& path, const std::string& content);
     void WriteFileBytes(const std::filesystem::path& path, const std::vector<u8>& content);
     std::string ReadFile(const std::filesystem::path& path);
     std::vector<u8> ReadFileBytes(const std::filesystem::path& path);
+    Ref<MappedFile> MapFile(const std::filesystem::path& path);
     void ReadTexture(const std::filesystem::path& path, std::vector<u8>& data, i32& w, i32& h);
 }
\ No newline at end of file
@@ -3,10 +3,16 @@
 #include "AssetManager.hpp"
 #include "Serializer.hpp"
 #include "AssetIO.hpp"
+#include "MeshProcessing.hpp"
+#include "GeometryCodec.hpp"
+#include "StaticBatching.hpp"
+#include "ThreadPool.hpp"
 #include "Util.hpp"
 
 #include <imgui/imgui.h>
 #include <random>
+#include <thread>
+#include <unordered_set>
 #include <utility>
 
 Object::~Object()
@@ -75,11 +81,76 @@ void TextureAsset::Serialize(Serializer& s) {
     s("width", width);
     s("height", height);
     s("channels", channels);
+    s("mipLevels", mipLevels);
+    s("content", content);
+    s("encoding", encoding);
 }
 
 void MeshAsset::Serialize(Serializer& s) {
-    s.Vector("vertices", vertices);
-    s.Vector("indices", indices);
+    // vertices and triangles are stored compressed, projects saved before keep loading the raw arrays
+    if (s.dir == Serializer::SAVE && indices.size() % 3 == 0) {
+        u64 vertexCount = vertices.size();
+        u64 indexCount = indices.size();
+        std::vector<u8> vertexStream = GeometryCodec::EncodeVertices(vertices.data(), vertices.size(), sizeof(MeshVertex));
+        std::vector<u8> indexStream = GeometryCodec::EncodeTriangles(indices.data(), indices.size());
+        s("vertexCount", vertexCount);
+        s("indexCount", indexCount);
+        s.Vector("vertexStream", vertexStream);
+        s.Vector("indexStream", indexStream);
+    } else if (s.dir == Serializer::LOAD && s.j.contains("vertexStream")) {
+        u64 vertexCount = 0;
+        u64 indexCount = 0;
+        const u8* vertexStream = nullptr;
+        const u8* indexStream = nullptr;
+        u64 vertexStreamSize = 0;
+        u64 indexStreamSize = 0;
+        s("vertexCount", vertexCount);
+        s("indexCount", indexCount);
+        if (s.Bytes("vertexStream", vertexStream, vertexStreamSize) && s.Bytes("indexStream", indexStream, indexStreamSize)) {
+            vertices.resize(vertexCount);
+            indices.resize(indexCount);
+            s.storage.deferred.push_back([=, this]() {
+                if (!GeometryCodec::DecodeVertices(vertices.data(), vertexCount, sizeof(MeshVertex), vertexStream, vertexStreamSize)
+                    || !GeometryCodec::DecodeTriangles(indices.data(), indexCount, sizeof(u32), indexStream, indexStreamSize)) {
+                    LOG_ERROR("Failed to decode mesh {}", name);
+                    vertices.clear();
+                    indices.clear();
+                }
+            });
+        }
+    } else {
+        s.Vector("vertices", vertices);
+        // meshes addressable with 16 bits store narrowed indices, they are widened again while loaded
+        if (s.dir == Serializer::SAVE) {
+            if (vertices.size() <= MaxVertices16) {
+                std::vector<u16> indices16(indices.begin(), indices.end());
+                s.Vector("indices16", indices16);
+            } else {
+                s.Vector("indices", indices);
+            }
+        } else {
+            std::vector<u16> indices16;
+            s.Vector("indices16", indices16);
+            if (!indices16.empty()) {
+                indices.assign(indices16.begin(), indices16.end());
+            } else {
+                s.Vector("indices", indices);
+            }
+        }
+    }
+    s.Vector("meshlets", meshlets);
+    s.Vector("lods", lods);
+    s.Vector("occlusion", occlusion);
+    s("packedVertices", packedVertices);
+    // projects saved before bounds existed compute them while loading
+    if (s.dir == Serializer::LOAD && !s.j.contains("aabbMin")) {
+        MeshProcessing::ComputeBounds(*this);
+    } else {
+        s("aabbMin", aabbMin);
+        s("aabbMax", aabbMax);
+        s("sphereCenter", sphereCenter);
+        s("sphereRadius", sphereRadius);
+    }
 }
 
 void MaterialAsset::Serialize(Serializer& s) {
@@ -102,10 +173,16 @@ void SceneAsset::Serialize(Serializer& s) {
     s("aoSamples", aoSamples);
     s("aoMin", aoMin);
     s("aoMax", aoMax);
+    s("aoBakeSamples", aoBakeSamples);
     s("exposure", exposure);
     s("shadowType", shadowType);
     s("taaEnabled", taaEnabled);
     s("taaReconstruct", taaReconstruct);
+    s("clusterCulling", clusterCulling);
+    s("lodPixelError", lodPixelError);
+    s("shadowLodBias", shadowLodBias);
+    s("staticBatching", staticBatching);
+    s("batchCellSize", batchCellSize);
     s.Node("mainCamera", mainCamera, this);
 }
 
@@ -120,6 +197,26 @@ void MeshNode::Serialize(Serializer& s) {
     Node::Serialize(s);
     s.Asset("mesh", mesh);
     s.Asset("material", material);
+    s("static", isStatic);
+}
+
+void MeshNode::UpdateWorldBounds(const glm::mat4& worldTransform) {
+    if (!mesh) {
+        worldMin = worldMax = worldCenter = glm::vec3(worldTransform[3]);
+        worldRadius = 0.0f;
+        return;
+    }
+    // the box extent projected on every world axis
+    glm::vec3 center = worldTransform * glm::vec4((mesh->aabbMin + mesh->aabbMax) * 0.5f, 1.0f);
+    glm::vec3 halfSize = (mesh->aabbMax - mesh->aabbMin) * 0.5f;
+    glm::vec3 extent = glm::abs(glm::vec3(worldTransform[0])) * halfSize.x
+        + glm::abs(glm::vec3(worldTransform[1])) * halfSize.y
+        + glm::abs(glm::vec3(worldTransform[2])) * halfSize.z;
+    worldMin = center - extent;
+    worldMax = center + extent;
+    float scale = glm::max(glm::length(glm::vec3(worldTransform[0])), glm::max(glm::length(glm::vec3(worldTransform[1])), glm::length(glm::vec3(worldTransform[2]))));
+    worldCenter = worldTransform * glm::vec4(mesh->sphereCenter, 1.0f);
+    worldRadius = mesh->sphereRadius * scale;
 }
 
 void LightNode::Serialize(Serializer& s) {
@@ -145,6 +242,20 @@ void LightNode::Serialize(Serializer& s) {
 
 // Asset Manager
 
+// files dropped together, each one is imported into its own manager and merged on the main thread
+struct ImportJob {
+    std::vector<std::string> paths;
+    std::vector<u64> keys;
+    std::vector<UUID> roots;
+    std::vector<Ref<AssetManager>> results;
+    std::unique_ptr<AssetIO::ImportProgress[]> progress;
+    // import cache when the job started, hits resolve to assets of the main manager
+    std::unordered_map<u64, UUID> cache;
+    std::atomic<bool> finished = false;
+    bool cancelled = false;
+    std::thread thread;
+};
+
 struct AssetManagerImpl {
     u32 lastAssetsHash = 0;
     Json lastJson;
@@ -152,6 +263,14 @@ struct AssetManagerImpl {
     std::filesystem::path currentBinPath;
     std::filesystem::path requestedProjectPath;
     std::filesystem::path requestedBinPath;
+    // AssetIO::ImportKey to the root asset created by that import
+    std::unordered_map<u64, UUID> importCache;
+    // texture payloads don't change after import, so their hashes are only computed once
+    std::unordered_map<UUID, u64> textureHashes;
+    // index of every asset in lastJson["assets"], evicted data is read back from storedBinPath through it
+    std::unordered_map<UUID, u32> storedAssets;
+    std::filesystem::path storedBinPath;
+    std::vector<std::unique_ptr<ImportJob>> importJobs;
 };
 
 AssetManager::AssetManager() {
@@ -159,6 +278,8 @@ AssetManager::AssetManager() {
 }
 
 AssetManager::~AssetManager() {
+    CancelImports();
+    WaitImports();
     delete impl;
 }
 
@@ -179,17 +300,32 @@ Ref<CameraNode> AssetManager::GetMainCamera(Ref<SceneAsset>& scene) {
     return scene->mainCamera;
 }
 
+static void IndexStoredAssets(AssetManagerImpl& impl, const std::filesystem::path& binPath) {
+    impl.storedAssets.clear();
+    const Json& stored = impl.lastJson["assets"];
+    for (u32 i = 0; i < stored.size(); i++) {
+        impl.storedAssets[stored[i]["uuid"].get<UUID>()] = i;
+    }
+    impl.storedBinPath = binPath;
+}
+
 void AssetManager::LoadProject(const std::filesystem::path& path, const std::filesystem::path& binPath) {
     TimeScope t("AssetManager::LoadProject", true);
+    // imports still running belong to the previous project
+    CancelImports();
     if (!std::ifstream(path)) {
         Log::Error("Project file not found: {} {}", path.string(), binPath.string());
         return;
     }
+    // assets already loaded stay in the manager but can't be read back once the stored json is replaced
+    for (const Ref<Asset>& asset : GetAll()) {
+        MakeResident(asset);
+    }
     Json j;
     BinaryStorage storage;
     int dir = Serializer::LOAD;
     j = Json::parse(AssetIO::ReadFile(path));
-    storage.data = AssetIO::ReadFileBytes(binPath);
+    storage.file = AssetIO::MapFile(binPath);
     std::vector<UUID> uuids;
     for (auto& assetJson : j["assets"]) {
         Ref<Asset> asset;
@@ -197,32 +333,110 @@ void AssetManager::LoadProject(const std::filesystem::path& path, const std::fil
         s.Serialize(asset);
         uuids.push_back(asset->uuid);
     }
+    ThreadPool::ParallelFor(u32(storage.deferred.size()), [&](u32 i) {
+        storage.deferred[i]();
+    });
     for (auto& assetJson : j["scenes"]) {
         Ref<Asset> asset;
         Serializer s = Serializer(assetJson, storage, dir, *this);
         s.Serialize(asset);
         uuids.push_back(asset->uuid);
     }
-    initialScene = j["initialScene"];
+    initialScene = j["initialScene"].get<UUID>();
+    impl->importCache.clear();
+    if (j.contains("importCache")) {
+        for (auto& entry : j["importCache"]) {
+            impl->importCache[entry[0].get<u64>()] = entry[1].get<UUID>();
+        }
+    }
     for (auto& scene : GetAll<SceneAsset>(ObjectType::SceneAsset)) {
         scene->UpdateParents();
     }
     impl->lastJson = std::move(j);
+    IndexStoredAssets(*impl, binPath);
     impl->lastAssetsHash = HashUUID(uuids);
     impl->currentProjectPath = path;
     impl->currentBinPath = binPath;
 }
 
+// frees the vertices or pixels of an asset whose data can be read back from the .luzbin
+static size_t ReleaseData(Asset& asset) {
+    size_t bytes = 0;
+    if (asset.type == ObjectType::MeshAsset) {
+        MeshAsset& mesh = (MeshAsset&)asset;
+        bytes = mesh.vertices.capacity() * sizeof(MeshAsset::MeshVertex) + mesh.indices.capacity() * sizeof(u32);
+        std::vector<MeshAsset::MeshVertex>().swap(mesh.vertices);
+        std::vector<u32>().swap(mesh.indices);
+    } else if (asset.type == ObjectType::TextureAsset) {
+        TextureAsset& texture = (TextureAsset&)asset;
+        bytes = texture.data.capacity();
+        std::vector<u8>().swap(texture.data);
+    }
+    asset.resident = false;
+    return bytes;
+}
+
+size_t AssetManager::Evict(const Ref<Asset>& asset) {
+    if (residency != Residency::EvictUploaded || !asset->resident || asset->gpuDirty) {
+        return 0;
+    }
+    if (asset->type != ObjectType::MeshAsset && asset->type != ObjectType::TextureAsset) {
+        return 0;
+    }
+    // static batching merges the vertices of small meshes on the cpu every time a batch is rebuilt
+    if (asset->type == ObjectType::MeshAsset && ((MeshAsset&)*asset).vertices.size() <= StaticBatching::MaxSourceVertices) {
+        return 0;
+    }
+    // imported assets keep their data until a save writes it to the .luzbin
+    if (!impl->storedAssets.count(asset->uuid)) {
+        return 0;
+    }
+    return ReleaseData(*asset);
+}
+
+bool AssetManager::MakeResident(const Ref<Asset>& asset) {
+    if (asset->resident) {
+        return true;
+    }
+    LUZ_PROFILE_NAMED("MakeResident");
+    auto stored = impl->storedAssets.find(asset->uuid);
+    if (stored == impl->storedAssets.end()) {
+        LOG_ERROR("Data of {} isn't stored in the project", asset->name);
+        return false;
+    }
+    BinaryStorage storage;
+    storage.file = AssetIO::MapFile(impl->storedBinPath);
+    if (!storage.file) {
+        LOG_ERROR("Failed to read the data of {} from {}", asset->name, impl->storedBinPath.string());
+        return false;
+    }
+    Serializer s(impl->lastJson["assets"][stored->second], storage, Serializer::LOAD, *this);
+    asset->Serialize(s);
+    for (auto& job : storage.deferred) {
+        job();
+    }
+    asset->resident = true;
+    return true;
+}
+
+void AssetManager::MarkModified(const Ref<Asset>& asset) {
+    // the stored copy is outdated, so every asset is written again by the next save
+    impl->storedAssets.erase(asset->uuid);
+    impl->textureHashes.erase(asset->uuid);
+    impl->lastAssetsHash = 0;
+    asset->gpuDirty = true;
+}
+
 void AssetManager::SaveProject(const std::filesystem::path& path, const std::filesystem::path& binPath) {
     TimeScope t("AssetManager::SaveProject", true);
+    DeduplicateTextures();
     BinaryStorage storage;
     int dir = Serializer::SAVE;
-    std::vector<Ref<Asset>> assetsOrdered;
+    std::vector<Ref<Asset>> assetsOrdered = GetAll();
     std::vector<UUID> assetsUUIDs;
-    assetsOrdered.reserve(assets.size());
-    for (auto& assetPair : assets) {
-        assetsOrdered.push_back(assetPair.second);
-        assetsUUIDs.push_back(assetPair.first);
+    assetsUUIDs.reserve(assetsOrdered.size());
+    for (const Ref<Asset>& asset : assetsOrdered) {
+        assetsUUIDs.push_back(asset->uuid);
     }
     u32 assetsHash = HashUUID(assetsUUIDs);
     if (assetsHash != impl->lastAssetsHash) {
@@ -237,13 +451,22 @@ void AssetManager::SaveProject(const std::filesystem::path& path, const std::fil
             if (asset->type == ObjectType::SceneAsset) {
                 continue;
             }
+            // evicted data is read back from the previous .luzbin only while the asset is written
+            bool evicted = !asset->resident;
+            if (evicted && !MakeResident(asset)) {
+                LOG_ERROR("Saving {} without its data", asset->name);
+            }
             Json assetJson;
             Serializer s = Serializer(assetJson, storage, dir, *this);
             s.Serialize(asset);
             j["assets"].push_back(assetJson);
+            if (evicted) {
+                ReleaseData(*asset);
+            }
         }
         AssetIO::WriteFileBytes(binPath, storage.data);
         impl->lastJson = std::move(j);
+        IndexStoredAssets(*impl, binPath);
     }
     // always serialize scenes
     for (auto& scene : GetAll<SceneAsset>(ObjectType::SceneAsset)) {
@@ -251,45 +474,311 @@ void AssetManager::SaveProject(const std::filesystem::path& path, const std::fil
         Serializer s = Serializer(assetJson, storage, dir, *this);
         s.Serialize(scene);
     }
-    impl->lastJson["initialScene"] = initialScene;
+    impl->lastJson["initialScene"] = initialScene.load();
+    Json& importCache = impl->lastJson["importCache"] = Json::array();
+    for (auto& [key, uuid] : impl->importCache) {
+        if (assets.Contains(uuid)) {
+            importCache.push_back({ key, uuid });
+        }
+    }
     AssetIO::WriteFile(path, impl->lastJson.dump());
     impl->lastAssetsHash = assetsHash;
 }
 
 void AssetManager::OnImgui() {
-     for (auto& assetPair : assets) {
-         auto& asset = assetPair.second;
+     assets.ForEach([](const Ref<Asset>& asset) {
          if (ImGui::TreeNode(&asset->uuid, "%s", asset->name.c_str())) {
              ImGui::TreePop();
          }
-     }
+     });
 }
 
 UUID AssetManager::NewUUID() {
     // todo: replace with something actually UUID
-    static std::random_device rd;
-    static std::mt19937_64 eng(rd());
-    static std::uniform_int_distribution<u64> dist(std::llround(std::pow(2,61)), std::llround(std::pow(2,62)));
+    // every thread draws from its own engine, only seeding touches the shared random device
+    thread_local std::mt19937_64 eng = [] {
+        static std::random_device rd;
+        static std::mutex mutex;
+        std::lock_guard lock(mutex);
+        std::seed_seq seed = { rd(), rd(), rd(), rd(), u32(std::hash<std::thread::id>()(std::this_thread::get_id())) };
+        return std::mt19937_64(seed);
+    }();
+    std::uniform_int_distribution<u64> dist(u64(1) << 61, u64(1) << 62);
     return dist(eng);
 }
 
+static bool SamePixels(const TextureAsset& a, const TextureAsset& b) {
+    return a.width == b.width && a.height == b.height && a.channels == b.channels && a.mipLevels == b.mipLevels
+        && a.encoding == b.encoding && a.data == b.data;
+}
+
+void AssetManager::Merge(AssetManager& other) {
+    for (const Ref<Asset>& asset : other.GetAll()) {
+        assets.Insert(asset);
+    }
+    other.assets.Clear();
+}
+
+void AssetManager::DeduplicateTextures() {
+    LUZ_PROFILE_NAMED("DeduplicateTextures");
+    std::vector<Ref<TextureAsset>> textures = GetAll<TextureAsset>(ObjectType::TextureAsset);
+    // oldest uuid first so the asset kept doesn't depend on the hash map order
+    std::sort(textures.begin(), textures.end(), [](const auto& a, const auto& b) { return a->uuid < b->uuid; });
+    std::vector<u64> hashes(textures.size());
+    for (size_t i = 0; i < textures.size(); i++) {
+        auto cached = impl->textureHashes.find(textures[i]->uuid);
+        if (cached == impl->textureHashes.end()) {
+            // evicted pixels are read back one texture at a time and dropped again once hashed
+            bool evicted = !textures[i]->resident;
+            MakeResident(textures[i]);
+            const TextureAsset& t = *textures[i];
+            u64 header[] = { u64(t.width), u64(t.height), u64(t.mipLevels), u64(t.encoding) };
+            cached = impl->textureHashes.emplace(t.uuid, Hash64(t.data.data(), t.data.size(), Hash64(header, sizeof(header)))).first;
+            if (evicted) {
+                ReleaseData(*textures[i]);
+            }
+        }
+        hashes[i] = cached->second;
+    }
+    // textures with the same hash are compared, evicted ones are only resident for the comparison
+    const auto samePixels = [&](const Ref<TextureAsset>& a, const Ref<TextureAsset>& b) {
+        bool evictedA = !a->resident;
+        bool evictedB = !b->resident;
+        bool same = MakeResident(a) && MakeResident(b) && SamePixels(*a, *b);
+        if (evictedA) {
+            ReleaseData(*a);
+        }
+        if (evictedB) {
+            ReleaseData(*b);
+        }
+        return same;
+    };
+    std::unordered_multimap<u64, Ref<TextureAsset>> unique;
+    std::unordered_map<UUID, Ref<TextureAsset>> replacements;
+    for (size_t i = 0; i < textures.size(); i++) {
+        Ref<TextureAsset> original;
+        auto range = unique.equal_range(hashes[i]);
+        for (auto it = range.first; it != range.second; it++) {
+            if (samePixels(it->second, textures[i])) {
+                original = it->second;
+                break;
+            }
+        }
+        if (original) {
+            replacements[textures[i]->uuid] = original;
+        } else {
+            unique.emplace(hashes[i], textures[i]);
+        }
+    }
+    if (replacements.empty()) {
+        return;
+    }
+    const auto replace = [&](Ref<TextureAsset>& texture) {
+        if (texture) {
+            auto it = replacements.find(texture->uuid);
+            if (it != replacements.end()) {
+                texture = it->second;
+            }
+        }
+    };
+    for (auto& material : GetAll<MaterialAsset>(ObjectType::MaterialAsset)) {
+        replace(material->aoMap);
+        replace(material->colorMap);
+        replace(material->normalMap);
+        replace(material->emissionMap);
+        replace(material->metallicRoughnessMap);
+    }
+    for (auto& [uuid, original] : replacements) {
+        assets.Erase(uuid);
+        impl->textureHashes.erase(uuid);
+    }
+    LOG_INFO("Merged {} duplicated textures", replacements.size());
+}
+
+// adds the assets reachable from the node and its children
+static void MarkNode(const Ref<Node>& node, std::unordered_set<UUID>& marked) {
+    if (node->type == ObjectType::MeshNode) {
+        const MeshNode& meshNode = *std::dynamic_pointer_cast<MeshNode>(node);
+        if (meshNode.mesh) {
+            marked.insert(meshNode.mesh->uuid);
+        }
+        if (const Ref<MaterialAsset>& material = meshNode.material) {
+            marked.insert(material->uuid);
+            for (const Ref<TextureAsset>* texture : { &material->aoMap, &material->colorMap, &material->normalMap, &material->emissionMap, &material->metallicRoughnessMap }) {
+                if (*texture) {
+                    marked.insert((*texture)->uuid);
+                }
+            }
+        }
+    }
+    for (const Ref<Node>& child : node->children) {
+        MarkNode(child, marked);
+    }
+}
+
+size_t AssetManager::CollectGarbage() {
+    LUZ_PROFILE_NAMED("CollectGarbage");
+    std::unordered_set<UUID> imports;
+    for (auto& [key, uuid] : impl->importCache) {
+        imports.insert(uuid);
+    }
+    std::unordered_set<UUID> marked;
+    std::vector<Ref<SceneAsset>> importScenes;
+    for (const Ref<SceneAsset>& scene : GetAll<SceneAsset>(ObjectType::SceneAsset)) {
+        if (imports.count(scene->uuid) && scene->uuid != initialScene) {
+            importScenes.push_back(scene);
+            continue;
+        }
+        marked.insert(scene->uuid);
+        for (const Ref<Node>& node : scene->nodes) {
+            MarkNode(node, marked);
+        }
+    }
+    for (const Ref<SceneAsset>& scene : importScenes) {
+        std::unordered_set<UUID> sceneAssets;
+        for (const Ref<Node>& node : scene->nodes) {
+            MarkNode(node, sceneAssets);
+        }
+        if (std::any_of(sceneAssets.begin(), sceneAssets.end(), [&](UUID uuid) { return marked.count(uuid) > 0; })) {
+            marked.insert(scene->uuid);
+            marked.insert(sceneAssets.begin(), sceneAssets.end());
+        }
+    }
+    size_t removed = 0;
+    for (const Ref<Asset>& asset : GetAll()) {
+        if (!marked.count(asset->uuid)) {
+            assets.Erase(asset->uuid);
+            impl->textureHashes.erase(asset->uuid);
+            removed++;
+        }
+    }
+    std::erase_if(impl->importCache, [&](const auto& entry) { return !marked.count(entry.second); });
+    if (removed) {
+        LOG_INFO("Collected {} unreferenced assets", removed);
+    }
+    return removed;
+}
+
 std::vector<Ref<Node>> AssetManager::AddAssetsToScene(Ref<SceneAsset>& scene, const std::vector<std::string>& paths) {
     LUZ_PROFILE_NAMED("AddAssetsToScene");
+    ImportAsync(paths);
+    WaitImports();
+    return AddImportedAssets(scene);
+}
+
+void AssetManager::ImportAsync(const std::vector<std::string>& paths) {
+    if (paths.empty()) {
+        return;
+    }
+    auto job = std::make_unique<ImportJob>();
+    job->paths = paths;
+    job->keys.resize(paths.size());
+    job->roots.resize(paths.size());
+    job->results.resize(paths.size());
+    job->progress = std::make_unique<AssetIO::ImportProgress[]>(paths.size());
+    job->cache = impl->importCache;
+    job->thread = std::thread([job = job.get()] {
+        ThreadPool::ParallelFor(u32(job->paths.size()), [&](u32 i) {
+            if (job->progress[i].cancel) {
+                return;
+            }
+            // dropping the same file again only clones the nodes of the scene imported the first time
+            job->keys[i] = AssetIO::ImportKey(job->paths[i]);
+            auto cached = job->cache.find(job->keys[i]);
+            if (job->keys[i] != 0 && cached != job->cache.end()) {
+                job->roots[i] = cached->second;
+                job->progress[i].steps = AssetIO::ImportSteps;
+                return;
+            }
+            job->results[i] = std::make_shared<AssetManager>();
+            job->roots[i] = AssetIO::Import(job->paths[i], *job->results[i], {}, &job->progress[i]);
+        });
+        job->finished = true;
+    });
+    impl->importJobs.push_back(std::move(job));
+}
+
+std::vector<Ref<Node>> AssetManager::AddImportedAssets(Ref<SceneAsset>& scene) {
     std::vector<Ref<Node>> newNodes;
-    for (const auto& path : paths) {
-        UUID uuid = AssetIO::Import(path, *this);
-        if (uuid != 0 && assets[uuid]->type == ObjectType::SceneAsset) {
-            auto sceneAsset = Get<SceneAsset>(uuid);
-            for (auto& node : sceneAsset->nodes) {
-                Ref<Node> nodeClone = Node::Clone(node);
-                scene->nodes.push_back(nodeClone);
-                newNodes.push_back(nodeClone);
+    bool imported = false;
+    auto& jobs = impl->importJobs;
+    for (auto it = jobs.begin(); it != jobs.end();) {
+        ImportJob& job = **it;
+        if (!job.finished) {
+            it++;
+            continue;
+        }
+        if (job.thread.joinable()) {
+            job.thread.join();
+        }
+        for (u32 i = 0; i < job.paths.size() && !job.cancelled; i++) {
+            UUID uuid = job.roots[i];
+            if (uuid == 0) {
+                if (!job.progress[i].cancel) {
+                    LOG_ERROR("Failed to import {}", job.paths[i]);
+                }
+                continue;
+            }
+            if (job.results[i]) {
+                Merge(*job.results[i]);
+                if (job.keys[i] != 0) {
+                    impl->importCache[job.keys[i]] = uuid;
+                }
+                imported = true;
+            } else if (assets.Contains(uuid)) {
+                LOG_INFO("Reusing assets imported from {}", job.paths[i]);
+            } else {
+                LOG_WARN("Assets imported from {} were removed while importing it again", job.paths[i]);
+                continue;
+            }
+            if (assets.Find(uuid)->type == ObjectType::SceneAsset) {
+                auto sceneAsset = Get<SceneAsset>(uuid);
+                for (auto& node : sceneAsset->nodes) {
+                    Ref<Node> nodeClone = Node::Clone(node);
+                    scene->nodes.push_back(nodeClone);
+                    newNodes.push_back(nodeClone);
+                }
             }
         }
+        it = jobs.erase(it);
+    }
+    // runs before the next frame uploads the new textures, so duplicates never reach the gpu
+    if (imported) {
+        DeduplicateTextures();
     }
     return newNodes;
 }
 
+bool AssetManager::GetImportProgress(float& progress, u32& files) const {
+    u32 steps = 0;
+    files = 0;
+    for (const auto& job : impl->importJobs) {
+        for (u32 i = 0; i < job->paths.size(); i++) {
+            steps += job->progress[i].steps;
+        }
+        files += u32(job->paths.size());
+    }
+    progress = files ? float(steps) / (files * AssetIO::ImportSteps) : 0.0f;
+    return files > 0;
+}
+
+void AssetManager::CancelImports() {
+    for (auto& job : impl->importJobs) {
+        job->cancelled = true;
+        for (u32 i = 0; i < job->paths.size(); i++) {
+            job->progress[i].cancel = true;
+        }
+    }
+}
+
+void AssetManager::WaitImports() {
+    for (auto& job : impl->importJobs) {
+        if (job->thread.joinable()) {
+            job->thread.join();
+        }
+    }
+}
+
 void SceneAsset::DeleteRecursive(const Ref<Node>& node) {
     auto it = std::find_if(nodes.begin(), nodes.end(), [&](auto& child) {
         return child->uuid == node->uuid;
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <atomic>
 #include <filesystem>
 #include <mutex>
+#include <shared_mutex>
 #include <unordered_map>
 #include <memory>
 
@@ -65,15 +67,36 @@ struct Object {
 };
 
 struct Asset : Object {
+    // false once the cpu copy of the vertices or pixels was dropped after the gpu upload, see AssetManager::Evict
+    bool resident = true;
+
     virtual ~Asset();
     virtual void Serialize(Serializer& s) = 0;
 };
 
 struct TextureAsset : Asset {
+    // what the texels hold, decided by the material slot using the texture
+    enum class Content {
+        Color,
+        Data,
+        Normal,
+        Occlusion,
+    };
+    enum class Encoding {
+        RGBA8,
+        BC1,
+        BC4,
+        BC5,
+        BC7,
+    };
+    // every mip level follows the previous one, level 0 first
     std::vector<u8> data;
     int channels = 0;
     int width = 0;
     int height = 0;
+    int mipLevels = 1;
+    Content content = Content::Color;
+    Encoding encoding = Encoding::RGBA8;
 
     TextureAsset();
     virtual void Serialize(Serializer& s);
@@ -89,8 +112,47 @@ struct MeshAsset : Asset {
             return position == o.position && normal == o.normal && texCoord == o.texCoord;
         }
     };
+    // 20 byte gpu vertex, positions are snorm inside the mesh bounds, normal and tangent are octahedral snorm,
+    // the tangent sign is stored in position[3] and uvs are half floats
+    struct PackedVertex {
+        i16 position[4];
+        i16 normalTangent[4];
+        u16 texCoord[2];
+    };
+    // contiguous range of indices with bounds used for cluster culling
+    struct Meshlet {
+        glm::vec3 center;
+        float radius;
+        glm::vec3 coneAxis;
+        // sine of the normal cone half angle, 1 when the cone can't be used for culling
+        float coneCutoff;
+        u32 firstIndex;
+        u32 indexCount;
+    };
+    // simplified level of detail, lod 0 is the full mesh and every level owns its own index and meshlet range
+    struct Lod {
+        u32 firstIndex;
+        u32 indexCount;
+        u32 firstMeshlet;
+        u32 meshletCount;
+        // object space distance from the full mesh
+        float error;
+    };
+    // meshes with at most this many vertices use 16 bit indices on disk and on the gpu
+    inline static constexpr u32 MaxVertices16 = 1 << 16;
     std::vector<MeshVertex> vertices;
     std::vector<u32> indices;
+    std::vector<Meshlet> meshlets;
+    std::vector<Lod> lods;
+    // baked ambient occlusion of every vertex, 255 is unoccluded. empty unless OcclusionBaking baked the mesh
+    std::vector<u8> occlusion;
+    // upload PackedVertex instead of MeshVertex
+    bool packedVertices = false;
+    // object space bounds of the positions, the sphere is centered on the box
+    glm::vec3 aabbMin = glm::vec3(0.0f);
+    glm::vec3 aabbMax = glm::vec3(0.0f);
+    glm::vec3 sphereCenter = glm::vec3(0.0f);
+    float sphereRadius = 0.0f;
 
     MeshAsset();
     virtual void Serialize(Serializer& s);
@@ -176,9 +238,18 @@ struct Node : Object {
 struct MeshNode : Node {
     Ref<MeshAsset> mesh;
     Ref<MaterialAsset> material;
+    // static nodes may be merged into batches with others sharing their material, they stay editable as proxies
+    bool isStatic = false;
+    // world space bounds of the mesh, refreshed by UpdateWorldBounds whenever the scene is uploaded
+    glm::vec3 worldMin = glm::vec3(0.0f);
+    glm::vec3 worldMax = glm::vec3(0.0f);
+    glm::vec3 worldCenter = glm::vec3(0.0f);
+    float worldRadius = 0.0f;
 
     MeshNode();
     virtual void Serialize(Serializer& s);
+    void UpdateWorldBounds(const glm::mat4& worldTransform);
+    void UpdateWorldBounds() { UpdateWorldBounds(GetWorldTransform()); }
 };
 
 struct LightNode : Node {
@@ -282,6 +353,8 @@ struct SceneAsset : Asset {
     int lightSamples = 2;
     float aoMin = 0.0001f;
     float aoMax = 1.0000f;
+    // rays per vertex traced by OcclusionBaking
+    int aoBakeSamples = 256;
     float exposure = 2.0f;
     ShadowType shadowType = ShadowType::ShadowRayTraced;
     uint32_t shadowResolution = 1024;
@@ -295,6 +368,16 @@ struct SceneAsset : Asset {
     bool taaEnabled = true;
     bool taaReconstruct = true;
 
+    bool clusterCulling = true;
+    // highest simplification error allowed on screen, in pixels
+    float lodPixelError = 1.0f;
+    // levels added to the selected lod when rendering shadow maps
+    int shadowLodBias = 1;
+
+    bool staticBatching = true;
+    // static nodes are merged with nodes in the same cell of this size
+    float batchCellSize = 32.0f;
+
     template<typename T>
     Ref<T> Add() {
         Ref<T> node = std::make_shared<T>();
@@ -352,44 +435,156 @@ struct SceneAsset : Asset {
     virtual void Serialize(Serializer& s);
 };
 
+// assets by uuid, spread over shards locked independently so worker threads can create and look up assets
+// of the same manager concurrently
+struct AssetRegistry {
+    static constexpr u32 ShardBits = 6;
+    static constexpr u32 ShardCount = 1 << ShardBits;
+
+    Ref<Asset> Find(UUID uuid) const {
+        const Shard& shard = GetShard(uuid);
+        std::shared_lock lock(shard.mutex);
+        auto it = shard.assets.find(uuid);
+        return it != shard.assets.end() ? it->second : nullptr;
+    }
+
+    bool Contains(UUID uuid) const {
+        const Shard& shard = GetShard(uuid);
+        std::shared_lock lock(shard.mutex);
+        return shard.assets.find(uuid) != shard.assets.end();
+    }
+
+    // replaces the asset with the same uuid
+    void Insert(const Ref<Asset>& asset) {
+        Shard& shard = GetShard(asset->uuid);
+        std::unique_lock lock(shard.mutex);
+        shard.assets[asset->uuid] = asset;
+    }
+
+    bool Erase(UUID uuid) {
+        Shard& shard = GetShard(uuid);
+        std::unique_lock lock(shard.mutex);
+        return shard.assets.erase(uuid) > 0;
+    }
+
+    void Clear() {
+        for (Shard& shard : shards) {
+            std::unique_lock lock(shard.mutex);
+            shard.assets.clear();
+        }
+    }
+
+    size_t Size() const {
+        size_t size = 0;
+        for (const Shard& shard : shards) {
+            std::shared_lock lock(shard.mutex);
+            size += shard.assets.size();
+        }
+        return size;
+    }
+
+    // visits every asset shard by shard, the shard being visited is locked so f must not modify the registry
+    template<typename F>
+    void ForEach(F&& f) const {
+        for (const Shard& shard : shards) {
+            std::shared_lock lock(shard.mutex);
+            for (const auto& [uuid, asset] : shard.assets) {
+                f(asset);
+            }
+        }
+    }
+
+private:
+    // one cache line per shard so threads locking neighbouring shards don't share it
+    struct alignas(64) Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<UUID, Ref<Asset>> assets;
+    };
+    Shard shards[ShardCount];
+
+    // uuids are random but imported ones may not be, the top bits of a multiplicative hash pick the shard
+    static u32 ShardIndex(UUID uuid) {
+        return u32((uuid * 0x9E3779B97F4A7C15ull) >> (64 - ShardBits));
+    }
+    Shard& GetShard(UUID uuid) { return shards[ShardIndex(uuid)]; }
+    const Shard& GetShard(UUID uuid) const { return shards[ShardIndex(uuid)]; }
+};
+
 struct AssetManager {
     AssetManager();
     ~AssetManager();
+    // imports the files and adds their nodes to the scene, blocking until every file is done
     std::vector<Ref<Node>> AddAssetsToScene(Ref<SceneAsset>& scene, const std::vector<std::string>& paths);
+    // imports the files on a background thread, several files are imported concurrently
+    void ImportAsync(const std::vector<std::string>& paths);
+    // adds the assets of finished background imports and their nodes to the scene, called once per frame
+    std::vector<Ref<Node>> AddImportedAssets(Ref<SceneAsset>& scene);
+    // progress in [0, 1] over all unfinished imports, returns false when nothing is importing
+    bool GetImportProgress(float& progress, u32& files) const;
+    void CancelImports();
+    void WaitImports();
     void LoadProject(const std::filesystem::path& path, const std::filesystem::path& binPath);
     void SaveProject(const std::filesystem::path& path, const std::filesystem::path& binPath);
     Ref<SceneAsset> GetInitialScene();
     Ref<CameraNode> GetMainCamera(Ref<SceneAsset>& scene);
+    // moves every asset of other into this manager, the initial scene is kept
+    void Merge(AssetManager& other);
+    // merges textures with identical pixels and format into one asset, materials are redirected to it
+    void DeduplicateTextures();
+    // removes assets no scene reaches through its nodes, meshes and materials. scenes created by an import stay
+    // while any of their assets is in use, so importing the file again reuses them. returns the removed count
+    size_t CollectGarbage();
+    // drops the cpu copy of an uploaded mesh or texture when the residency policy allows it, returns the freed bytes
+    size_t Evict(const Ref<Asset>& asset);
+    // reads the data of an evicted asset back from the project .luzbin, false if it couldn't be read
+    bool MakeResident(const Ref<Asset>& asset);
+    // called after the data of a resident asset changed, it's uploaded again and stays resident until the next
+    // save writes it to the .luzbin
+    void MarkModified(const Ref<Asset>& asset);
     void OnImgui();
 
+    // creating, getting and removing assets is safe from any thread, the project and import functions
+    // above still run on the main thread
     template<typename T>
-    Ref<T> Get(UUID uuid) {
-        return std::dynamic_pointer_cast<T>(assets[uuid]);
+    Ref<T> Get(UUID uuid) const {
+        return std::dynamic_pointer_cast<T>(assets.Find(uuid));
     }
 
-    Ref<Asset> Get(UUID uuid) {
-        return assets[uuid];
+    Ref<Asset> Get(UUID uuid) const {
+        return assets.Find(uuid);
     }
 
     template<typename T>
     std::vector<Ref<T>> GetAll(ObjectType type) const {
         std::vector<Ref<T>> all;
-        for (auto& pair : assets) {
-            if (pair.second->type == type) {
-                all.emplace_back(std::dynamic_pointer_cast<T>(pair.second));
+        assets.ForEach([&](const Ref<Asset>& asset) {
+            if (asset->type == type) {
+                all.emplace_back(std::dynamic_pointer_cast<T>(asset));
             }
-        }
+        });
         return all;
     }
 
     std::vector<Ref<Asset>> GetAll() const {
         std::vector<Ref<Asset>> all;
-        for (auto& pair : assets) {
-            all.emplace_back(std::dynamic_pointer_cast<Asset>(pair.second));
-        }
+        assets.ForEach([&](const Ref<Asset>& asset) {
+            all.emplace_back(asset);
+        });
         return all;
     }
 
+    // what happens to the cpu copy of mesh vertices and texture pixels once the gpu has them
+    enum class Residency {
+        KeepResident,
+        // assets stored in the project .luzbin drop it, meshes small enough for static batching always keep it
+        EvictUploaded,
+    };
+    Residency residency = Residency::EvictUploaded;
+
+    size_t AssetCount() const {
+        return assets.Size();
+    }
+
     template<typename T>
     static Ref<T> CreateObject(const std::string& name, UUID uuid = 0) {
         if (uuid == 0) {
@@ -409,9 +604,10 @@ struct AssetManager {
         Ref<T> a = std::make_shared<T>();
         a->name = name;
         a->uuid = uuid;
-        assets[a->uuid] = a;
-        if (a->type == ObjectType::SceneAsset && !initialScene) {
-            initialScene = a->uuid;
+        assets.Insert(a);
+        if (a->type == ObjectType::SceneAsset) {
+            UUID none = 0;
+            initialScene.compare_exchange_strong(none, a->uuid);
         }
         return a;
     }
@@ -470,7 +666,7 @@ struct AssetManager {
 
 private:
     struct AssetManagerImpl* impl;
-    std::unordered_map<UUID, Ref<Asset>> assets;
+    AssetRegistry assets;
     static UUID NewUUID();
-    UUID initialScene = 0;
+    std::atomic<UUID> initialScene = 0;
 };
\ No newline at end of file
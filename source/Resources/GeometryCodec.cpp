@@ -0,0 +1,767 @@
+#include "Luzpch.hpp"
+
+#include "GeometryCodec.hpp"
+
+#if defined(__SSSE3__) || defined(__AVX__)
+#include <tmmintrin.h>
+#define LUZ_SSSE3
+#endif
+
+namespace GeometryCodec {
+
+static constexpr u8 VertexHeader = 0xa0;
+static constexpr u8 TriangleHeader = 0xe0;
+static constexpr u8 SequenceHeader = 0xd0;
+static constexpr int TriangleVersion = 1;
+
+static constexpr size_t VertexBlockSizeBytes = 8192;
+static constexpr size_t VertexBlockMaxSize = 256;
+static constexpr size_t ByteGroupSize = 16;
+// a group reads at most 8 bytes of selectors and 16 explicit bytes, checking this once per group keeps the
+// decoder free of per byte bounds checks
+static constexpr size_t ByteGroupDecodeLimit = 24;
+// the first vertex is stored at the end of the stream padded to this size, the padding covers the group limit
+static constexpr size_t TailMinSize = 32;
+
+// symbol table of the auxiliary triangle codes, gathered from frequencies on a set of meshes
+static constexpr u8 CodeAuxTable[16] = {
+    0x00, 0x76, 0x87, 0x56, 0x67, 0x78, 0xa9, 0x86, 0x65, 0x89, 0x68, 0x98, 0x01, 0x69, 0x00, 0x00,
+};
+
+static size_t VertexBlockSize(size_t vertexSize) {
+    size_t result = (VertexBlockSizeBytes / vertexSize) & ~(ByteGroupSize - 1);
+    return std::min(result, VertexBlockMaxSize);
+}
+
+static size_t TailSize(size_t vertexSize) {
+    return std::max(vertexSize, TailMinSize);
+}
+
+static u8 Zigzag8(u8 v) {
+    return u8((i8(v) >> 7) ^ (v << 1));
+}
+
+static size_t MeasureGroup(const u8* values, int bits) {
+    if (bits == 0) {
+        for (size_t i = 0; i < ByteGroupSize; i++) {
+            if (values[i] != 0) {
+                return SIZE_MAX;
+            }
+        }
+        return 0;
+    }
+    size_t size = ByteGroupSize * bits / 8;
+    u8 sentinel = u8((1 << bits) - 1);
+    for (size_t i = 0; i < ByteGroupSize; i++) {
+        size += values[i] >= sentinel;
+    }
+    return size;
+}
+
+// values that don't fit the bit width store the sentinel and follow the packed selectors as whole bytes
+static void EncodeGroup(std::vector<u8>& out, const u8* values, int bits) {
+    if (bits == 0) {
+        return;
+    }
+    if (bits == 8) {
+        out.insert(out.end(), values, values + ByteGroupSize);
+        return;
+    }
+    u8 sentinel = u8((1 << bits) - 1);
+    size_t selectors = out.size();
+    out.resize(out.size() + ByteGroupSize * bits / 8, 0);
+    for (size_t i = 0; i < ByteGroupSize; i++) {
+        size_t bit = i * bits;
+        out[selectors + bit / 8] |= u8(std::min(values[i], sentinel) << (8 - bits - bit % 8));
+    }
+    for (size_t i = 0; i < ByteGroupSize; i++) {
+        if (values[i] >= sentinel) {
+            out.push_back(values[i]);
+        }
+    }
+}
+
+static void EncodeBytes(std::vector<u8>& out, const u8* values, size_t count) {
+    static constexpr int groupBits[4] = { 0, 2, 4, 8 };
+    size_t header = out.size();
+    out.resize(out.size() + (count / ByteGroupSize + 3) / 4, 0);
+    for (size_t i = 0; i < count; i += ByteGroupSize) {
+        int best = 3;
+        size_t bestSize = ByteGroupSize;
+        for (int mode = 0; mode < 3; mode++) {
+            size_t size = MeasureGroup(values + i, groupBits[mode]);
+            if (size < bestSize) {
+                best = mode;
+                bestSize = size;
+            }
+        }
+        size_t group = i / ByteGroupSize;
+        out[header + group / 4] |= u8(best << (group % 4 * 2));
+        EncodeGroup(out, values + i, groupBits[best]);
+    }
+}
+
+std::vector<u8> EncodeVertices(const void* vertices, size_t vertexCount, size_t vertexSize) {
+    DEBUG_ASSERT(vertexSize > 0 && vertexSize <= MaxVertexSize && vertexSize % 4 == 0, "Invalid vertex size {}", vertexSize);
+    const u8* bytes = (const u8*)vertices;
+    std::vector<u8> out;
+    out.reserve(1 + vertexCount * vertexSize / 2 + TailSize(vertexSize));
+    out.push_back(VertexHeader);
+
+    u8 firstVertex[MaxVertexSize] = {};
+    if (vertexCount > 0) {
+        memcpy(firstVertex, bytes, vertexSize);
+    }
+    u8 lastVertex[MaxVertexSize];
+    memcpy(lastVertex, firstVertex, vertexSize);
+
+    u8 deltas[VertexBlockMaxSize];
+    size_t blockSize = VertexBlockSize(vertexSize);
+    for (size_t first = 0; first < vertexCount; first += blockSize) {
+        size_t count = std::min(blockSize, vertexCount - first);
+        size_t alignedCount = (count + ByteGroupSize - 1) & ~(ByteGroupSize - 1);
+        const u8* block = bytes + first * vertexSize;
+        for (size_t k = 0; k < vertexSize; k++) {
+            u8 previous = lastVertex[k];
+            for (size_t i = 0; i < count; i++) {
+                u8 value = block[i * vertexSize + k];
+                deltas[i] = Zigzag8(u8(value - previous));
+                previous = value;
+            }
+            memset(deltas + count, 0, alignedCount - count);
+            EncodeBytes(out, deltas, alignedCount);
+            lastVertex[k] = previous;
+        }
+    }
+
+    out.resize(out.size() + TailSize(vertexSize) - vertexSize, 0);
+    out.insert(out.end(), firstVertex, firstVertex + vertexSize);
+    return out;
+}
+
+#if !defined(LUZ_SSSE3)
+static u8 Unzigzag8(u8 v) {
+    return u8(-(v & 1) ^ (v >> 1));
+}
+
+static const u8* DecodeGroupScalar(const u8* data, u8* destination, int mode) {
+    switch (mode) {
+    case 0:
+        memset(destination, 0, ByteGroupSize);
+        return data;
+    case 3:
+        memcpy(destination, data, ByteGroupSize);
+        return data + ByteGroupSize;
+    default:
+        int bits = mode * 2;
+        u8 sentinel = u8((1 << bits) - 1);
+        const u8* explicitBytes = data + ByteGroupSize * bits / 8;
+        for (size_t i = 0; i < ByteGroupSize; i++) {
+            size_t bit = i * bits;
+            u8 value = (data[bit / 8] >> (8 - bits - bit % 8)) & sentinel;
+            destination[i] = value == sentinel ? *explicitBytes++ : value;
+        }
+        return explicitBytes;
+    }
+}
+#else
+struct GroupTables {
+    // shuffle[mask] gathers the explicit bytes into the lanes of the set mask bits, the others read zero
+    u8 shuffle[256][8];
+    u8 count[256];
+
+    GroupTables() {
+        for (int mask = 0; mask < 256; mask++) {
+            u8 next = 0;
+            for (int i = 0; i < 8; i++) {
+                shuffle[mask][i] = (mask & (1 << i)) ? next++ : 0x80;
+            }
+            count[mask] = next;
+        }
+    }
+};
+
+static const GroupTables groupTables;
+
+// selectors equal to the sentinel are replaced by the explicit bytes in order
+static const u8* ResolveGroupSSSE3(const u8* explicitBytes, u8* destination, __m128i selectors, __m128i sentinel) {
+    __m128i mask = _mm_cmpeq_epi8(selectors, sentinel);
+    int mask16 = _mm_movemask_epi8(mask);
+    u8 mask0 = u8(mask16 & 255);
+    u8 mask1 = u8(mask16 >> 8);
+    __m128i shuffle0 = _mm_loadl_epi64((const __m128i*)groupTables.shuffle[mask0]);
+    __m128i shuffle1 = _mm_add_epi8(_mm_loadl_epi64((const __m128i*)groupTables.shuffle[mask1]), _mm_set1_epi8(char(groupTables.count[mask0])));
+    __m128i shuffle = _mm_unpacklo_epi64(shuffle0, shuffle1);
+    __m128i rest = _mm_loadu_si128((const __m128i*)explicitBytes);
+    __m128i result = _mm_or_si128(_mm_shuffle_epi8(rest, shuffle), _mm_andnot_si128(mask, selectors));
+    _mm_storeu_si128((__m128i*)destination, result);
+    return explicitBytes + groupTables.count[mask0] + groupTables.count[mask1];
+}
+
+static const u8* DecodeGroupSSSE3(const u8* data, u8* destination, int mode) {
+    switch (mode) {
+    case 0:
+        _mm_storeu_si128((__m128i*)destination, _mm_setzero_si128());
+        return data;
+    case 1: {
+        i32 packed;
+        memcpy(&packed, data, sizeof(packed));
+        // unpack msb first pairs of bits into bytes, shifting 16 bit lanes leaks bits only above the kept ones
+        __m128i sel2 = _mm_cvtsi32_si128(packed);
+        __m128i sel22 = _mm_unpacklo_epi8(_mm_srli_epi16(sel2, 4), sel2);
+        __m128i sel2222 = _mm_unpacklo_epi8(_mm_srli_epi16(sel22, 2), sel22);
+        __m128i selectors = _mm_and_si128(sel2222, _mm_set1_epi8(3));
+        return ResolveGroupSSSE3(data + 4, destination, selectors, _mm_set1_epi8(3));
+    }
+    case 2: {
+        __m128i sel4 = _mm_loadl_epi64((const __m128i*)data);
+        __m128i sel44 = _mm_unpacklo_epi8(_mm_srli_epi16(sel4, 4), sel4);
+        __m128i selectors = _mm_and_si128(sel44, _mm_set1_epi8(15));
+        return ResolveGroupSSSE3(data + 8, destination, selectors, _mm_set1_epi8(15));
+    }
+    default:
+        _mm_storeu_si128((__m128i*)destination, _mm_loadu_si128((const __m128i*)data));
+        return data + ByteGroupSize;
+    }
+}
+#endif
+
+static const u8* DecodeBytes(const u8* data, const u8* dataEnd, u8* destination, size_t count) {
+    size_t headerSize = (count / ByteGroupSize + 3) / 4;
+    if (size_t(dataEnd - data) < headerSize) {
+        return nullptr;
+    }
+    const u8* header = data;
+    data += headerSize;
+    for (size_t i = 0; i < count; i += ByteGroupSize) {
+        if (size_t(dataEnd - data) < ByteGroupDecodeLimit) {
+            return nullptr;
+        }
+        size_t group = i / ByteGroupSize;
+        int mode = (header[group / 4] >> (group % 4 * 2)) & 3;
+#if defined(LUZ_SSSE3)
+        data = DecodeGroupSSSE3(data, destination + i, mode);
+#else
+        data = DecodeGroupScalar(data, destination + i, mode);
+#endif
+    }
+    return data;
+}
+
+#if defined(LUZ_SSSE3)
+static __m128i Unzigzag8(__m128i v) {
+    __m128i sign = _mm_sub_epi8(_mm_setzero_si128(), _mm_and_si128(v, _mm_set1_epi8(1)));
+    return _mm_xor_si128(sign, _mm_and_si128(_mm_srli_epi16(v, 1), _mm_set1_epi8(127)));
+}
+
+// four byte planes of 16 vertices become 16 rows of 4 bytes, each row is summed with the ones before it
+static __m128i PrefixSumRows(__m128i rows, __m128i last) {
+    rows = _mm_add_epi8(rows, _mm_slli_si128(rows, 4));
+    rows = _mm_add_epi8(rows, _mm_slli_si128(rows, 8));
+    return _mm_add_epi8(rows, last);
+}
+
+static void StoreRows(u8* destination, size_t vertexSize, __m128i rows) {
+    for (int i = 0; i < 4; i++) {
+        i32 row = _mm_cvtsi128_si32(rows);
+        memcpy(destination + i * vertexSize, &row, sizeof(row));
+        rows = _mm_srli_si128(rows, 4);
+    }
+}
+#endif
+
+static const u8* DecodeVertexBlock(const u8* data, const u8* dataEnd, u8* destination, size_t vertexCount, size_t vertexSize, u8* lastVertex) {
+    u8 planes[VertexBlockMaxSize * 4];
+    // rows of the padded vertex count are written, full blocks go straight to the destination and the last one
+    // through a scratch block, which never exceeds VertexBlockSizeBytes
+    u8 scratch[VertexBlockSizeBytes];
+    size_t alignedCount = (vertexCount + ByteGroupSize - 1) & ~(ByteGroupSize - 1);
+    u8* rows = alignedCount == vertexCount ? destination : scratch;
+    for (size_t k = 0; k < vertexSize; k += 4) {
+        for (size_t j = 0; j < 4; j++) {
+            data = DecodeBytes(data, dataEnd, planes + j * alignedCount, alignedCount);
+            if (!data) {
+                return nullptr;
+            }
+        }
+#if defined(LUZ_SSSE3)
+        i32 lastBytes;
+        memcpy(&lastBytes, lastVertex + k, sizeof(lastBytes));
+        __m128i last = _mm_set1_epi32(lastBytes);
+        for (size_t i = 0; i < alignedCount; i += ByteGroupSize) {
+            __m128i r0 = Unzigzag8(_mm_loadu_si128((const __m128i*)(planes + 0 * alignedCount + i)));
+            __m128i r1 = Unzigzag8(_mm_loadu_si128((const __m128i*)(planes + 1 * alignedCount + i)));
+            __m128i r2 = Unzigzag8(_mm_loadu_si128((const __m128i*)(planes + 2 * alignedCount + i)));
+            __m128i r3 = Unzigzag8(_mm_loadu_si128((const __m128i*)(planes + 3 * alignedCount + i)));
+            __m128i t0 = _mm_unpacklo_epi8(r0, r1);
+            __m128i t1 = _mm_unpackhi_epi8(r0, r1);
+            __m128i t2 = _mm_unpacklo_epi8(r2, r3);
+            __m128i t3 = _mm_unpackhi_epi8(r2, r3);
+            __m128i rows0 = PrefixSumRows(_mm_unpacklo_epi16(t0, t2), last);
+            __m128i rows1 = PrefixSumRows(_mm_unpackhi_epi16(t0, t2), _mm_shuffle_epi32(rows0, 0xff));
+            __m128i rows2 = PrefixSumRows(_mm_unpacklo_epi16(t1, t3), _mm_shuffle_epi32(rows1, 0xff));
+            __m128i rows3 = PrefixSumRows(_mm_unpackhi_epi16(t1, t3), _mm_shuffle_epi32(rows2, 0xff));
+            last = _mm_shuffle_epi32(rows3, 0xff);
+            u8* out = rows + i * vertexSize + k;
+            StoreRows(out + 0 * vertexSize, vertexSize, rows0);
+            StoreRows(out + 4 * vertexSize, vertexSize, rows1);
+            StoreRows(out + 8 * vertexSize, vertexSize, rows2);
+            StoreRows(out + 12 * vertexSize, vertexSize, rows3);
+        }
+#else
+        for (size_t j = 0; j < 4; j++) {
+            u8 previous = lastVertex[k + j];
+            const u8* plane = planes + j * alignedCount;
+            for (size_t i = 0; i < vertexCount; i++) {
+                previous = u8(previous + Unzigzag8(plane[i]));
+                rows[i * vertexSize + k + j] = previous;
+            }
+        }
+#endif
+    }
+    if (rows == scratch) {
+        memcpy(destination, rows, vertexCount * vertexSize);
+    }
+    memcpy(lastVertex, rows + (vertexCount - 1) * vertexSize, vertexSize);
+    return data;
+}
+
+bool DecodeVertices(void* destination, size_t vertexCount, size_t vertexSize, const u8* data, size_t size) {
+    if (vertexSize == 0 || vertexSize > MaxVertexSize || vertexSize % 4 != 0) {
+        return false;
+    }
+    size_t tailSize = TailSize(vertexSize);
+    if (size < 1 + tailSize || (data[0] & 0xf0) != VertexHeader || (data[0] & 0x0f) != 0) {
+        return false;
+    }
+    const u8* dataEnd = data + size;
+    u8 lastVertex[MaxVertexSize];
+    memcpy(lastVertex, dataEnd - vertexSize, vertexSize);
+    data++;
+
+    size_t blockSize = VertexBlockSize(vertexSize);
+    for (size_t first = 0; first < vertexCount; first += blockSize) {
+        size_t count = std::min(blockSize, vertexCount - first);
+        data = DecodeVertexBlock(data, dataEnd, (u8*)destination + first * vertexSize, count, vertexSize, lastVertex);
+        if (!data) {
+            return false;
+        }
+    }
+    return size_t(dataEnd - data) == tailSize;
+}
+
+// index triplets, a rotation of a triangle starting at the ith vertex
+static constexpr u32 TriangleOrder[3][3] = {
+    { 0, 1, 2 },
+    { 1, 2, 0 },
+    { 2, 0, 1 },
+};
+
+using EdgeFifo = u32[16][2];
+using VertexFifo = u32[16];
+
+static void PushEdge(EdgeFifo& fifo, u32 a, u32 b, size_t& offset) {
+    fifo[offset][0] = a;
+    fifo[offset][1] = b;
+    offset = (offset + 1) & 15;
+}
+
+static void PushVertex(VertexFifo& fifo, u32 v, size_t& offset, int condition = 1) {
+    fifo[offset] = v;
+    offset = (offset + condition) & 15;
+}
+
+// edge index shifted by 2 plus the rotation that makes the edge the first one of the triangle, or -1
+static int FindEdge(const EdgeFifo& fifo, u32 a, u32 b, u32 c, size_t offset) {
+    for (int i = 0; i < 16; i++) {
+        size_t index = (offset - 1 - i) & 15;
+        u32 e0 = fifo[index][0];
+        u32 e1 = fifo[index][1];
+        if (e0 == a && e1 == b) {
+            return (i << 2) | 0;
+        }
+        if (e0 == b && e1 == c) {
+            return (i << 2) | 1;
+        }
+        if (e0 == c && e1 == a) {
+            return (i << 2) | 2;
+        }
+    }
+    return -1;
+}
+
+static int FindVertex(const VertexFifo& fifo, u32 v, size_t offset) {
+    for (int i = 0; i < 16; i++) {
+        if (fifo[(offset - 1 - i) & 15] == v) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void EncodeVarint(std::vector<u8>& out, u32 v) {
+    do {
+        out.push_back(u8((v & 127) | (v > 127 ? 128 : 0)));
+        v >>= 7;
+    } while (v);
+}
+
+static u32 DecodeVarint(const u8*& data) {
+    u8 lead = *data++;
+    if (lead < 128) {
+        return lead;
+    }
+    u32 result = lead & 127;
+    u32 shift = 7;
+    for (int i = 0; i < 4; i++) {
+        u8 group = *data++;
+        result |= u32(group & 127) << shift;
+        shift += 7;
+        if (group < 128) {
+            break;
+        }
+    }
+    return result;
+}
+
+static void EncodeIndex(std::vector<u8>& out, u32 index, u32 last) {
+    u32 delta = index - last;
+    EncodeVarint(out, (delta << 1) ^ u32(i32(delta) >> 31));
+}
+
+static u32 DecodeIndex(const u8*& data, u32 last) {
+    u32 v = DecodeVarint(data);
+    return last + ((v >> 1) ^ u32(-i32(v & 1)));
+}
+
+std::vector<u8> EncodeTriangles(const u32* indices, size_t indexCount) {
+    DEBUG_ASSERT(indexCount % 3 == 0, "Index count {} isn't a triangle list", indexCount);
+    std::vector<u8> codes;
+    std::vector<u8> data;
+    codes.reserve(1 + indexCount / 3);
+    data.reserve(indexCount / 3 + 16);
+    codes.push_back(TriangleHeader | TriangleVersion);
+
+    EdgeFifo edgeFifo;
+    VertexFifo vertexFifo;
+    memset(edgeFifo, -1, sizeof(edgeFifo));
+    memset(vertexFifo, -1, sizeof(vertexFifo));
+    size_t edgeOffset = 0;
+    size_t vertexOffset = 0;
+    u32 next = 0;
+    u32 last = 0;
+    const int fecMax = 13;
+
+    for (size_t i = 0; i < indexCount; i += 3) {
+        int edge = FindEdge(edgeFifo, indices[i + 0], indices[i + 1], indices[i + 2], edgeOffset);
+        if (edge >= 0 && (edge >> 2) < 15) {
+            const u32* order = TriangleOrder[edge & 3];
+            u32 a = indices[i + order[0]];
+            u32 b = indices[i + order[1]];
+            u32 c = indices[i + order[2]];
+            int fe = edge >> 2;
+            int fc = FindVertex(vertexFifo, c, vertexOffset);
+            int fec = (fc >= 1 && fc < fecMax) ? fc : (c == next) ? (next++, 0) : 15;
+            // strips often continue right before or after the last free index
+            if (fec == 15 && c + 1 == last) {
+                fec = 13;
+                last = c;
+            } else if (fec == 15 && c == last + 1) {
+                fec = 14;
+                last = c;
+            }
+            codes.push_back(u8((fe << 4) | fec));
+            if (fec == 15) {
+                EncodeIndex(data, c, last);
+                last = c;
+            }
+            if (fec == 0 || fec >= fecMax) {
+                PushVertex(vertexFifo, c, vertexOffset);
+            }
+            PushEdge(edgeFifo, c, b, edgeOffset);
+            PushEdge(edgeFifo, a, c, edgeOffset);
+        } else {
+            u32 a = indices[i + 0];
+            u32 b = indices[i + 1];
+            u32 c = indices[i + 2];
+            int rotation = b == next ? 1 : c == next ? 2 : 0;
+            const u32* order = TriangleOrder[rotation];
+            a = indices[i + order[0]];
+            b = indices[i + order[1]];
+            c = indices[i + order[2]];
+            // 0, 1, 2 after the first vertices restarts the sequence, typical of concatenated meshes
+            bool reset = false;
+            if (a == 0 && b == 1 && c == 2 && next > 0) {
+                reset = true;
+                next = 0;
+                memset(vertexFifo, -1, sizeof(vertexFifo));
+            }
+            int fb = FindVertex(vertexFifo, b, vertexOffset);
+            int fc = FindVertex(vertexFifo, c, vertexOffset);
+            int fea = (a == next) ? (next++, 0) : 15;
+            int feb = (fb >= 0 && fb < 14) ? fb + 1 : (b == next) ? (next++, 0) : 15;
+            int fec = (fc >= 0 && fc < 14) ? fc + 1 : (c == next) ? (next++, 0) : 15;
+            u8 codeAux = u8((feb << 4) | fec);
+            int codeAuxIndex = -1;
+            for (int t = 0; t < 14; t++) {
+                if (CodeAuxTable[t] == codeAux) {
+                    codeAuxIndex = t;
+                    break;
+                }
+            }
+            if (fea == 0 && codeAuxIndex >= 0 && !reset) {
+                codes.push_back(u8(0xf0 | codeAuxIndex));
+            } else {
+                codes.push_back(u8(0xf0 | 14 | (fea ? 1 : 0)));
+                data.push_back(codeAux);
+            }
+            if (fea == 15) {
+                EncodeIndex(data, a, last);
+                last = a;
+            }
+            if (feb == 15) {
+                EncodeIndex(data, b, last);
+                last = b;
+            }
+            if (fec == 15) {
+                EncodeIndex(data, c, last);
+                last = c;
+            }
+            if (fea == 0 || fea == 15) {
+                PushVertex(vertexFifo, a, vertexOffset);
+            }
+            if (feb == 0 || feb == 15) {
+                PushVertex(vertexFifo, b, vertexOffset);
+            }
+            if (fec == 0 || fec == 15) {
+                PushVertex(vertexFifo, c, vertexOffset);
+            }
+            PushEdge(edgeFifo, b, a, edgeOffset);
+            PushEdge(edgeFifo, c, b, edgeOffset);
+            PushEdge(edgeFifo, a, c, edgeOffset);
+        }
+    }
+
+    // the table doubles as padding, the decoder reads a whole triangle without bounds checks
+    codes.insert(codes.end(), data.begin(), data.end());
+    codes.insert(codes.end(), CodeAuxTable, CodeAuxTable + 16);
+    return codes;
+}
+
+static void WriteIndex(void* destination, size_t i, size_t indexSize, u32 index) {
+    if (indexSize == 2) {
+        ((u16*)destination)[i] = u16(index);
+    } else {
+        ((u32*)destination)[i] = index;
+    }
+}
+
+static void WriteTriangle(void* destination, size_t i, size_t indexSize, u32 a, u32 b, u32 c) {
+    WriteIndex(destination, i + 0, indexSize, a);
+    WriteIndex(destination, i + 1, indexSize, b);
+    WriteIndex(destination, i + 2, indexSize, c);
+}
+
+bool DecodeTriangles(void* destination, size_t indexCount, size_t indexSize, const u8* data, size_t size) {
+    if (indexCount % 3 != 0 || (indexSize != 2 && indexSize != 4) || size < 1 + indexCount / 3 + 16) {
+        return false;
+    }
+    int version = data[0] & 0x0f;
+    if ((data[0] & 0xf0) != TriangleHeader || version > TriangleVersion) {
+        return false;
+    }
+
+    EdgeFifo edgeFifo;
+    VertexFifo vertexFifo;
+    memset(edgeFifo, -1, sizeof(edgeFifo));
+    memset(vertexFifo, -1, sizeof(vertexFifo));
+    size_t edgeOffset = 0;
+    size_t vertexOffset = 0;
+    u32 next = 0;
+    u32 last = 0;
+    // the first version has no last-1 and last+1 codes
+    int fecMax = version >= 1 ? 13 : 15;
+
+    const u8* code = data + 1;
+    const u8* free = code + indexCount / 3;
+    const u8* freeEnd = data + size - 16;
+    const u8* codeAuxTable = freeEnd;
+
+    for (size_t i = 0; i < indexCount; i += 3) {
+        // a triangle reads at most 16 bytes of free data, the table at the end absorbs the overrun
+        if (free > freeEnd) {
+            return false;
+        }
+        u8 codeTri = *code++;
+        if (codeTri < 0xf0) {
+            int fe = codeTri >> 4;
+            u32 a = edgeFifo[(edgeOffset - 1 - fe) & 15][0];
+            u32 b = edgeFifo[(edgeOffset - 1 - fe) & 15][1];
+            int fec = codeTri & 15;
+            if (fec < fecMax) {
+                u32 c = fec == 0 ? next : vertexFifo[(vertexOffset - 1 - fec) & 15];
+                int fec0 = fec == 0;
+                next += fec0;
+                WriteTriangle(destination, i, indexSize, a, b, c);
+                PushVertex(vertexFifo, c, vertexOffset, fec0);
+                PushEdge(edgeFifo, c, b, edgeOffset);
+                PushEdge(edgeFifo, a, c, edgeOffset);
+            } else {
+                // fec - (fec ^ 3) turns 13 and 14 into -1 and +1
+                u32 c = last = fec != 15 ? last + (fec - (fec ^ 3)) : DecodeIndex(free, last);
+                WriteTriangle(destination, i, indexSize, a, b, c);
+                PushVertex(vertexFifo, c, vertexOffset);
+                PushEdge(edgeFifo, c, b, edgeOffset);
+                PushEdge(edgeFifo, a, c, edgeOffset);
+            }
+        } else if (codeTri < 0xfe) {
+            u8 codeAux = codeAuxTable[codeTri & 15];
+            int feb = codeAux >> 4;
+            int fec = codeAux & 15;
+            // next is incremented for every vertex before the next one is decoded, as in the encoder
+            u32 a = next++;
+            u32 b = feb == 0 ? next : vertexFifo[(vertexOffset - feb) & 15];
+            int feb0 = feb == 0;
+            next += feb0;
+            u32 c = fec == 0 ? next : vertexFifo[(vertexOffset - fec) & 15];
+            int fec0 = fec == 0;
+            next += fec0;
+            WriteTriangle(destination, i, indexSize, a, b, c);
+            PushVertex(vertexFifo, a, vertexOffset);
+            PushVertex(vertexFifo, b, vertexOffset, feb0);
+            PushVertex(vertexFifo, c, vertexOffset, fec0);
+            PushEdge(edgeFifo, b, a, edgeOffset);
+            PushEdge(edgeFifo, c, b, edgeOffset);
+            PushEdge(edgeFifo, a, c, edgeOffset);
+        } else {
+            u8 codeAux = *free++;
+            int fea = codeTri == 0xfe ? 0 : 15;
+            int feb = codeAux >> 4;
+            int fec = codeAux & 15;
+            if (codeAux == 0) {
+                next = 0;
+            }
+            u32 a = fea == 0 ? next++ : 0;
+            u32 b = feb == 0 ? next++ : vertexFifo[(vertexOffset - feb) & 15];
+            u32 c = fec == 0 ? next++ : vertexFifo[(vertexOffset - fec) & 15];
+            if (fea == 15) {
+                last = a = DecodeIndex(free, last);
+            }
+            if (feb == 15) {
+                last = b = DecodeIndex(free, last);
+            }
+            if (fec == 15) {
+                last = c = DecodeIndex(free, last);
+            }
+            WriteTriangle(destination, i, indexSize, a, b, c);
+            PushVertex(vertexFifo, a, vertexOffset);
+            PushVertex(vertexFifo, b, vertexOffset, (feb == 0) | (feb == 15));
+            PushVertex(vertexFifo, c, vertexOffset, (fec == 0) | (fec == 15));
+            PushEdge(edgeFifo, b, a, edgeOffset);
+            PushEdge(edgeFifo, c, b, edgeOffset);
+            PushEdge(edgeFifo, a, c, edgeOffset);
+        }
+    }
+    return free == freeEnd;
+}
+
+bool DecodeIndexSequence(void* destination, size_t indexCount, size_t indexSize, const u8* data, size_t size) {
+    if ((indexSize != 2 && indexSize != 4) || size < 1 + indexCount + 4) {
+        return false;
+    }
+    if ((data[0] & 0xf0) != SequenceHeader || (data[0] & 0x0f) > 1) {
+        return false;
+    }
+    const u8* free = data + 1;
+    // a varint reads at most 5 bytes, the 4 byte tail absorbs the overrun
+    const u8* freeEnd = data + size - 4;
+    u32 last[2] = {};
+    for (size_t i = 0; i < indexCount; i++) {
+        if (free >= freeEnd) {
+            return false;
+        }
+        u32 v = DecodeVarint(free);
+        // the low bit selects the baseline, the rest is a zigzag delta to it
+        u32 baseline = v & 1;
+        v >>= 1;
+        u32 index = last[baseline] + ((v >> 1) ^ u32(-i32(v & 1)));
+        last[baseline] = index;
+        WriteIndex(destination, i, indexSize, index);
+    }
+    return free == freeEnd;
+}
+
+template<typename T>
+static void DecodeOctahedral(T* data, size_t count) {
+    const float max = float((1 << (sizeof(T) * 8 - 1)) - 1);
+    for (size_t i = 0; i < count; i++) {
+        // z is stored relative to the length of the encoding, which stays in the last component
+        float x = float(data[i * 4 + 0]);
+        float y = float(data[i * 4 + 1]);
+        float z = float(data[i * 4 + 2]) - std::abs(x) - std::abs(y);
+        float t = z >= 0.0f ? 0.0f : z;
+        x += x >= 0.0f ? t : -t;
+        y += y >= 0.0f ? t : -t;
+        float s = max / std::sqrt(x * x + y * y + z * z);
+        data[i * 4 + 0] = T(int(x * s + (x >= 0.0f ? 0.5f : -0.5f)));
+        data[i * 4 + 1] = T(int(y * s + (y >= 0.0f ? 0.5f : -0.5f)));
+        data[i * 4 + 2] = T(int(z * s + (z >= 0.0f ? 0.5f : -0.5f)));
+    }
+}
+
+static void DecodeQuaternion(i16* data, size_t count) {
+    const float scale = 1.0f / std::sqrt(2.0f);
+    for (size_t i = 0; i < count; i++) {
+        // the high bits of the last component hold the range of the other three, the low 2 bits the
+        // index of the largest component
+        int range = data[i * 4 + 3] | 3;
+        float ss = scale / float(range);
+        float x = float(data[i * 4 + 0]) * ss;
+        float y = float(data[i * 4 + 1]) * ss;
+        float z = float(data[i * 4 + 2]) * ss;
+        float ww = 1.0f - x * x - y * y - z * z;
+        float w = std::sqrt(ww >= 0.0f ? ww : 0.0f);
+        int largest = data[i * 4 + 3] & 3;
+        data[i * 4 + ((largest + 1) & 3)] = i16(int(x * 32767.0f + (x >= 0.0f ? 0.5f : -0.5f)));
+        data[i * 4 + ((largest + 2) & 3)] = i16(int(y * 32767.0f + (y >= 0.0f ? 0.5f : -0.5f)));
+        data[i * 4 + ((largest + 3) & 3)] = i16(int(z * 32767.0f + (z >= 0.0f ? 0.5f : -0.5f)));
+        data[i * 4 + ((largest + 0) & 3)] = i16(int(w * 32767.0f + 0.5f));
+    }
+}
+
+static void DecodeExponential(u32* data, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        i32 mantissa = i32(data[i] << 8) >> 8;
+        i32 exponent = i32(data[i]) >> 24;
+        // ldexp(mantissa, exponent) through the bits of 2^exponent
+        u32 bits = u32(exponent + 127) << 23;
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        value *= float(mantissa);
+        memcpy(&data[i], &value, sizeof(value));
+    }
+}
+
+void DecodeFilter(Filter filter, void* data, size_t count, size_t stride) {
+    switch (filter) {
+    case Filter::Octahedral:
+        if (stride == 4) {
+            DecodeOctahedral((i8*)data, count);
+        } else if (stride == 8) {
+            DecodeOctahedral((i16*)data, count);
+        }
+        break;
+    case Filter::Quaternion:
+        if (stride == 8) {
+            DecodeQuaternion((i16*)data, count);
+        }
+        break;
+    case Filter::Exponential:
+        DecodeExponential((u32*)data, count * stride / 4);
+        break;
+    default:
+        break;
+    }
+}
+
+}
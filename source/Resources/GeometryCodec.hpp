@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Base.hpp"
+
+#include <vector>
+
+// Lossless vertex and index compression. The streams follow the meshoptimizer bitstream, so the same decoders
+// read compressed .luzbin meshes and EXT_meshopt_compression glTF buffers.
+namespace GeometryCodec {
+
+inline constexpr size_t MaxVertexSize = 256;
+
+// every byte of a vertex is stored as the zigzag delta to the same byte of the previous vertex, the deltas of
+// one byte across a block of vertices are packed in groups of 16 using 0, 2, 4 or 8 bits per delta.
+// vertexSize must be a multiple of 4 and at most MaxVertexSize
+std::vector<u8> EncodeVertices(const void* vertices, size_t vertexCount, size_t vertexSize);
+bool DecodeVertices(void* destination, size_t vertexCount, size_t vertexSize, const u8* data, size_t size);
+
+// triangles are matched against a fifo of recent edges and one of recent vertices, indices missing from both
+// are varint deltas to the last free index. indexCount must be a multiple of 3
+std::vector<u8> EncodeTriangles(const u32* indices, size_t indexCount);
+// indexSize is the width of the written indices, 2 or 4 bytes
+bool DecodeTriangles(void* destination, size_t indexCount, size_t indexSize, const u8* data, size_t size);
+
+// index lists without triangle structure, varint deltas to one of two previous indices
+bool DecodeIndexSequence(void* destination, size_t indexCount, size_t indexSize, const u8* data, size_t size);
+
+// quantization filters applied over decoded attributes by EXT_meshopt_compression
+enum class Filter {
+    None,
+    // snorm octahedral normals, 4 x i8 or 4 x i16 with the length of the encoding in the last component
+    Octahedral,
+    // 4 x i16 quaternions storing the three smallest components and the index of the largest one
+    Quaternion,
+    // floats as 24 bit mantissa and 8 bit exponent
+    Exponential,
+};
+
+void DecodeFilter(Filter filter, void* data, size_t count, size_t stride);
+
+}
@@ -0,0 +1,1190 @@
+#include "Luzpch.hpp"
+
+#include "MeshProcessing.hpp"
+#include "ThreadPool.hpp"
+
+#include <glm/gtc/packing.hpp>
+#include <unordered_set>
+
+#if defined(__SSE__) || defined(_M_X64)
+#include <xmmintrin.h>
+#define LUZ_SSE
+#endif
+
+namespace MeshProcessing {
+
+using MeshVertex = MeshAsset::MeshVertex;
+
+static u64 HashVertex(const MeshVertex& v) {
+    // adding zero turns -0 into +0 so equal vertices hash equally
+    const float key[12] = {
+        v.position.x + 0.0f, v.position.y + 0.0f, v.position.z + 0.0f,
+        v.normal.x + 0.0f, v.normal.y + 0.0f, v.normal.z + 0.0f,
+        v.tangent.x + 0.0f, v.tangent.y + 0.0f, v.tangent.z + 0.0f, v.tangent.w + 0.0f,
+        v.texCoord.x + 0.0f, v.texCoord.y + 0.0f,
+    };
+    return Hash64(key, sizeof(key));
+}
+
+static bool SameVertex(const MeshVertex& a, const MeshVertex& b) {
+    return a == b && a.tangent == b.tangent;
+}
+
+VertexTable::VertexTable(size_t expectedVertices) {
+    size_t capacity = 64;
+    while (capacity < expectedVertices * 2) {
+        capacity *= 2;
+    }
+    slots.assign(capacity, ~0u);
+    mask = u32(capacity - 1);
+}
+
+u32 VertexTable::Insert(const MeshVertex& vertex, std::vector<MeshVertex>& vertices) {
+    if ((vertices.size() + 1) * 2 > slots.size()) {
+        Grow(vertices);
+    }
+    u32 slot = u32(HashVertex(vertex)) & mask;
+    while (slots[slot] != ~0u) {
+        if (SameVertex(vertices[slots[slot]], vertex)) {
+            return slots[slot];
+        }
+        slot = (slot + 1) & mask;
+    }
+    slots[slot] = u32(vertices.size());
+    vertices.push_back(vertex);
+    return slots[slot];
+}
+
+void VertexTable::Grow(const std::vector<MeshVertex>& vertices) {
+    slots.assign(slots.size() * 2, ~0u);
+    mask = u32(slots.size() - 1);
+    for (u32 i = 0; i < vertices.size(); i++) {
+        u32 slot = u32(HashVertex(vertices[i])) & mask;
+        while (slots[slot] != ~0u) {
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = i;
+    }
+}
+
+// fifo cache simulation, a vertex is cached while less than cacheSize misses happened after it was loaded
+struct CacheSimulator {
+    std::vector<u32> loadTime;
+    u32 time;
+    u32 cacheSize;
+
+    CacheSimulator(u32 vertexCount, u32 cacheSize)
+        : loadTime(vertexCount, 0)
+        , time(cacheSize + 1)
+        , cacheSize(cacheSize)
+    {}
+
+    u32 Triangle(const u32* triangle) {
+        u32 misses = 0;
+        for (u32 k = 0; k < 3; k++) {
+            if (time - loadTime[triangle[k]] > cacheSize) {
+                loadTime[triangle[k]] = time++;
+                misses++;
+            }
+        }
+        return misses;
+    }
+
+    void Flush() {
+        time += cacheSize + 1;
+    }
+};
+
+VertexCacheStats AnalyzeVertexCache(const std::vector<u32>& indices, u32 vertexCount, u32 cacheSize) {
+    VertexCacheStats stats;
+    stats.triangles = u32(indices.size() / 3);
+    CacheSimulator cache(vertexCount, cacheSize);
+    std::vector<bool> used(vertexCount, false);
+    for (u32 t = 0; t < stats.triangles; t++) {
+        stats.misses += cache.Triangle(&indices[t * 3]);
+        for (u32 k = 0; k < 3; k++) {
+            if (!used[indices[t * 3 + k]]) {
+                used[indices[t * 3 + k]] = true;
+                stats.vertices++;
+            }
+        }
+    }
+    return stats;
+}
+
+void WeldVertices(MeshAsset& mesh) {
+    std::vector<MeshVertex> welded;
+    welded.reserve(mesh.vertices.size());
+    std::vector<u32> remap(mesh.vertices.size());
+    VertexTable table(mesh.vertices.size());
+    for (u32 i = 0; i < mesh.vertices.size(); i++) {
+        remap[i] = table.Insert(mesh.vertices[i], welded);
+    }
+    for (u32& index : mesh.indices) {
+        index = remap[index];
+    }
+    mesh.vertices.swap(welded);
+}
+
+void RemoveDegenerateTriangles(MeshAsset& mesh) {
+    u32 count = 0;
+    for (u32 i = 0; i + 2 < mesh.indices.size(); i += 3) {
+        u32 a = mesh.indices[i + 0];
+        u32 b = mesh.indices[i + 1];
+        u32 c = mesh.indices[i + 2];
+        const glm::vec3& pa = mesh.vertices[a].position;
+        const glm::vec3& pb = mesh.vertices[b].position;
+        const glm::vec3& pc = mesh.vertices[c].position;
+        if (a == b || b == c || a == c || pa == pb || pb == pc || pa == pc) {
+            continue;
+        }
+        mesh.indices[count++] = a;
+        mesh.indices[count++] = b;
+        mesh.indices[count++] = c;
+    }
+    mesh.indices.resize(count);
+}
+
+// triangles around vertex v are adjacency[offsets[v]..offsets[v + 1]]
+static void BuildTriangleAdjacency(const u32* indices, u32 triangleCount, u32 vertexCount, std::vector<u32>& offsets, std::vector<u32>& adjacency) {
+    offsets.assign(vertexCount + 1, 0);
+    for (u32 i = 0; i < triangleCount * 3; i++) {
+        offsets[indices[i] + 1]++;
+    }
+    for (u32 v = 0; v < vertexCount; v++) {
+        offsets[v + 1] += offsets[v];
+    }
+    adjacency.resize(triangleCount * 3);
+    std::vector<u32> fill(offsets.begin(), offsets.end() - 1);
+    for (u32 i = 0; i < triangleCount * 3; i++) {
+        adjacency[fill[indices[i]]++] = i / 3;
+    }
+}
+
+std::vector<u32> OptimizeVertexCache(std::vector<u32>& indices, u32 vertexCount, u32 cacheSize) {
+    std::vector<u32> boundaries;
+    u32 triangleCount = u32(indices.size() / 3);
+    if (triangleCount == 0) {
+        return boundaries;
+    }
+
+    std::vector<u32> offsets;
+    std::vector<u32> adjacency;
+    BuildTriangleAdjacency(indices.data(), triangleCount, vertexCount, offsets, adjacency);
+
+    std::vector<u32> live(vertexCount);
+    for (u32 v = 0; v < vertexCount; v++) {
+        live[v] = offsets[v + 1] - offsets[v];
+    }
+    std::vector<u32> loadTime(vertexCount, 0);
+    std::vector<u8> emitted(triangleCount, 0);
+    std::vector<u32> deadEnd;
+    std::vector<u32> candidates;
+    std::vector<u32> output;
+    deadEnd.reserve(triangleCount * 3);
+    output.reserve(triangleCount * 3);
+    u32 time = cacheSize + 1;
+    u32 cursor = 0;
+
+    const auto skipDeadEnd = [&]() {
+        while (!deadEnd.empty()) {
+            u32 v = deadEnd.back();
+            deadEnd.pop_back();
+            if (live[v] > 0) {
+                return v;
+            }
+        }
+        while (cursor < vertexCount) {
+            if (live[cursor] > 0) {
+                return cursor;
+            }
+            cursor++;
+        }
+        return ~0u;
+    };
+
+    u32 fanning = skipDeadEnd();
+    boundaries.push_back(0);
+    while (fanning != ~0u) {
+        // emit every remaining triangle around the fanning vertex
+        candidates.clear();
+        for (u32 a = offsets[fanning]; a < offsets[fanning + 1]; a++) {
+            u32 t = adjacency[a];
+            if (emitted[t]) {
+                continue;
+            }
+            emitted[t] = 1;
+            for (u32 k = 0; k < 3; k++) {
+                u32 v = indices[t * 3 + k];
+                output.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                live[v]--;
+                if (time - loadTime[v] > cacheSize) {
+                    loadTime[v] = time++;
+                }
+            }
+        }
+
+        // prefer the oldest candidate that stays in cache while its triangles are emitted
+        u32 next = ~0u;
+        i64 bestPriority = -1;
+        for (u32 v : candidates) {
+            if (live[v] == 0) {
+                continue;
+            }
+            i64 priority = 0;
+            if (time - loadTime[v] + 2 * live[v] <= cacheSize) {
+                priority = time - loadTime[v];
+            }
+            if (priority > bestPriority) {
+                bestPriority = priority;
+                next = v;
+            }
+        }
+        if (next == ~0u) {
+            next = skipDeadEnd();
+            if (next != ~0u) {
+                boundaries.push_back(u32(output.size() / 3));
+            }
+        }
+        fanning = next;
+    }
+    indices.swap(output);
+    return boundaries;
+}
+
+void OptimizeOverdraw(MeshAsset& mesh, const std::vector<u32>& hardBoundaries, float threshold) {
+    std::vector<u32>& indices = mesh.indices;
+    u32 triangleCount = u32(indices.size() / 3);
+    if (triangleCount == 0) {
+        return;
+    }
+
+    // split hard clusters further where the cache efficiency is already close to the cluster average
+    std::vector<u32> clusters;
+    CacheSimulator cache(u32(mesh.vertices.size()), VertexCacheSize);
+    for (u32 h = 0; h < hardBoundaries.size(); h++) {
+        u32 start = hardBoundaries[h];
+        u32 end = h + 1 < hardBoundaries.size() ? hardBoundaries[h + 1] : triangleCount;
+        u32 clusterMisses = 0;
+        cache.Flush();
+        for (u32 t = start; t < end; t++) {
+            clusterMisses += cache.Triangle(&indices[t * 3]);
+        }
+        float clusterACMR = float(clusterMisses) / (end - start);
+
+        clusters.push_back(start);
+        u32 subStart = start;
+        u32 subMisses = 0;
+        cache.Flush();
+        for (u32 t = start; t < end; t++) {
+            subMisses += cache.Triangle(&indices[t * 3]);
+            if (t + 1 < end && float(subMisses) / (t + 1 - subStart) <= threshold * clusterACMR) {
+                clusters.push_back(t + 1);
+                subStart = t + 1;
+                subMisses = 0;
+                cache.Flush();
+            }
+        }
+    }
+
+    glm::vec3 meshCentroid = glm::vec3(0.0f);
+    for (const MeshVertex& v : mesh.vertices) {
+        meshCentroid += v.position;
+    }
+    meshCentroid /= float(std::max<size_t>(mesh.vertices.size(), 1));
+
+    // clusters facing away from the mesh center are likely to occlude others, draw them first
+    std::vector<float> sortKey(clusters.size());
+    for (u32 c = 0; c < clusters.size(); c++) {
+        u32 end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+        glm::vec3 centroid = glm::vec3(0.0f);
+        glm::vec3 normal = glm::vec3(0.0f);
+        float area = 0.0f;
+        for (u32 t = clusters[c]; t < end; t++) {
+            const glm::vec3& p0 = mesh.vertices[indices[t * 3 + 0]].position;
+            const glm::vec3& p1 = mesh.vertices[indices[t * 3 + 1]].position;
+            const glm::vec3& p2 = mesh.vertices[indices[t * 3 + 2]].position;
+            glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+            float a = glm::length(n);
+            centroid += (p0 + p1 + p2) * (a / 3.0f);
+            normal += n;
+            area += a;
+        }
+        centroid = area > 0.0f ? centroid / area : meshCentroid;
+        float length = glm::length(normal);
+        sortKey[c] = length > 0.0f ? glm::dot(centroid - meshCentroid, normal / length) : 0.0f;
+    }
+    std::vector<u32> order(clusters.size());
+    for (u32 c = 0; c < order.size(); c++) {
+        order[c] = c;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](u32 a, u32 b) {
+        return sortKey[a] > sortKey[b];
+    });
+
+    std::vector<u32> sorted;
+    sorted.reserve(indices.size());
+    for (u32 c : order) {
+        u32 end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+        sorted.insert(sorted.end(), indices.begin() + clusters[c] * 3, indices.begin() + end * 3);
+    }
+    indices.swap(sorted);
+}
+
+void OptimizeVertexFetch(MeshAsset& mesh) {
+    std::vector<u32> remap(mesh.vertices.size(), ~0u);
+    std::vector<MeshVertex> vertices;
+    vertices.reserve(mesh.vertices.size());
+    for (u32& index : mesh.indices) {
+        if (remap[index] == ~0u) {
+            remap[index] = u32(vertices.size());
+            vertices.push_back(mesh.vertices[index]);
+        }
+        index = remap[index];
+    }
+    mesh.vertices.swap(vertices);
+}
+
+static MeshAsset::Meshlet ComputeMeshletBounds(const MeshAsset& mesh, const u32* indices, u32 indexCount) {
+    MeshAsset::Meshlet meshlet = {};
+    glm::vec3 minPos = glm::vec3(FLT_MAX);
+    glm::vec3 maxPos = glm::vec3(-FLT_MAX);
+    for (u32 i = 0; i < indexCount; i++) {
+        minPos = glm::min(minPos, mesh.vertices[indices[i]].position);
+        maxPos = glm::max(maxPos, mesh.vertices[indices[i]].position);
+    }
+    meshlet.center = (minPos + maxPos) * 0.5f;
+    meshlet.radius = 0.0f;
+    for (u32 i = 0; i < indexCount; i++) {
+        meshlet.radius = std::max(meshlet.radius, glm::distance(meshlet.center, mesh.vertices[indices[i]].position));
+    }
+
+    std::vector<glm::vec3> normals;
+    glm::vec3 axis = glm::vec3(0.0f);
+    for (u32 i = 0; i + 2 < indexCount; i += 3) {
+        const glm::vec3& p0 = mesh.vertices[indices[i + 0]].position;
+        const glm::vec3& p1 = mesh.vertices[indices[i + 1]].position;
+        const glm::vec3& p2 = mesh.vertices[indices[i + 2]].position;
+        glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+        float length = glm::length(n);
+        if (length > 0.0f) {
+            normals.push_back(n / length);
+            axis += n / length;
+        }
+    }
+    float axisLength = glm::length(axis);
+    meshlet.coneAxis = axisLength > 0.0f ? axis / axisLength : glm::vec3(0, 0, 1);
+    float minDot = axisLength > 0.0f ? 1.0f : -1.0f;
+    for (const glm::vec3& n : normals) {
+        minDot = std::min(minDot, glm::dot(n, meshlet.coneAxis));
+    }
+    meshlet.coneCutoff = minDot <= 0.0f ? 1.0f : std::sqrt(1.0f - minDot * minDot);
+    return meshlet;
+}
+
+void BuildMeshlets(MeshAsset& mesh, u32 firstIndex, u32 indexCount, std::vector<MeshAsset::Meshlet>& meshlets, u32 maxVertices, u32 maxTriangles) {
+    const u32* indices = mesh.indices.data() + firstIndex;
+    u32 triangleCount = indexCount / 3;
+    u32 vertexCount = u32(mesh.vertices.size());
+    std::vector<u32> offsets;
+    std::vector<u32> adjacency;
+    BuildTriangleAdjacency(indices, triangleCount, vertexCount, offsets, adjacency);
+
+    std::vector<u8> assigned(triangleCount, 0);
+    std::vector<u32> vertexMeshlet(vertexCount, ~0u);
+    std::vector<u32> candidates;
+    std::vector<u32> output;
+    output.reserve(indexCount);
+    u32 cursor = 0;
+    u32 meshletId = 0;
+
+    while (true) {
+        while (cursor < triangleCount && assigned[cursor]) {
+            cursor++;
+        }
+        if (cursor == triangleCount) {
+            break;
+        }
+
+        u32 meshletStart = u32(output.size());
+        u32 meshletVertices = 0;
+        u32 meshletTriangles = 0;
+        glm::vec3 centroidSum = glm::vec3(0.0f);
+        candidates.clear();
+
+        const auto newVertices = [&](u32 t) {
+            u32 count = 0;
+            for (u32 k = 0; k < 3; k++) {
+                count += vertexMeshlet[indices[t * 3 + k]] != meshletId;
+            }
+            return count;
+        };
+        const auto triangleCentroid = [&](u32 t) {
+            return (mesh.vertices[indices[t * 3 + 0]].position + mesh.vertices[indices[t * 3 + 1]].position + mesh.vertices[indices[t * 3 + 2]].position) / 3.0f;
+        };
+        const auto addTriangle = [&](u32 t) {
+            assigned[t] = 1;
+            for (u32 k = 0; k < 3; k++) {
+                u32 v = indices[t * 3 + k];
+                output.push_back(v);
+                if (vertexMeshlet[v] != meshletId) {
+                    vertexMeshlet[v] = meshletId;
+                    meshletVertices++;
+                    for (u32 a = offsets[v]; a < offsets[v + 1]; a++) {
+                        if (!assigned[adjacency[a]]) {
+                            candidates.push_back(adjacency[a]);
+                        }
+                    }
+                }
+            }
+            centroidSum += triangleCentroid(t);
+            meshletTriangles++;
+        };
+
+        // grow through connectivity, preferring triangles that add fewer vertices and stay close to the center
+        addTriangle(cursor);
+        while (meshletTriangles < maxTriangles) {
+            glm::vec3 centroid = centroidSum / float(meshletTriangles);
+            u32 best = ~0u;
+            u32 bestNew = 4;
+            float bestDistance = FLT_MAX;
+            u32 kept = 0;
+            for (u32 t : candidates) {
+                if (assigned[t]) {
+                    continue;
+                }
+                candidates[kept++] = t;
+                u32 added = newVertices(t);
+                if (meshletVertices + added > maxVertices) {
+                    continue;
+                }
+                float distance = glm::distance2(centroid, triangleCentroid(t));
+                if (added < bestNew || (added == bestNew && distance < bestDistance)) {
+                    best = t;
+                    bestNew = added;
+                    bestDistance = distance;
+                }
+            }
+            candidates.resize(kept);
+            if (best == ~0u) {
+                break;
+            }
+            addTriangle(best);
+        }
+
+        MeshAsset::Meshlet meshlet = ComputeMeshletBounds(mesh, output.data() + meshletStart, u32(output.size()) - meshletStart);
+        meshlet.firstIndex = firstIndex + meshletStart;
+        meshlet.indexCount = u32(output.size()) - meshletStart;
+        meshlets.push_back(meshlet);
+        meshletId++;
+    }
+    memcpy(mesh.indices.data() + firstIndex, output.data(), output.size() * sizeof(u32));
+}
+
+// symmetric 4x4 quadric of squared plane distances, stores only the unique coefficients
+struct Quadric {
+    double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+    double b0 = 0, b1 = 0, b2 = 0;
+    double c = 0;
+    double weight = 0;
+
+    void AddPlane(const glm::dvec3& n, double d, double w) {
+        a00 += w * n.x * n.x;
+        a01 += w * n.x * n.y;
+        a02 += w * n.x * n.z;
+        a11 += w * n.y * n.y;
+        a12 += w * n.y * n.z;
+        a22 += w * n.z * n.z;
+        b0 += w * n.x * d;
+        b1 += w * n.y * d;
+        b2 += w * n.z * d;
+        c += w * d * d;
+        weight += w;
+    }
+
+    Quadric& operator+=(const Quadric& q) {
+        a00 += q.a00; a01 += q.a01; a02 += q.a02;
+        a11 += q.a11; a12 += q.a12; a22 += q.a22;
+        b0 += q.b0; b1 += q.b1; b2 += q.b2;
+        c += q.c;
+        weight += q.weight;
+        return *this;
+    }
+
+    // weighted mean of the squared distances from p to every plane
+    double Error(const glm::dvec3& p) const {
+        double e = a00 * p.x * p.x + a11 * p.y * p.y + a22 * p.z * p.z
+            + 2.0 * (a01 * p.x * p.y + a02 * p.x * p.z + a12 * p.y * p.z)
+            + 2.0 * (b0 * p.x + b1 * p.y + b2 * p.z) + c;
+        return weight > 0.0 ? std::max(e, 0.0) / weight : 0.0;
+    }
+};
+
+enum class VertexKind : u8 {
+    Manifold,
+    // single wedge on an open edge loop
+    Border,
+    // two wedges sharing a position on both sides of an attribute discontinuity
+    Seam,
+    Locked,
+};
+
+static constexpr double BorderWeight = 10.0;
+static constexpr double AttributeWeight = 0.01;
+
+float Simplify(const MeshAsset& mesh, const u32* indices, u32 indexCount, u32 targetIndexCount, float maxError, std::vector<u32>& output) {
+    output.assign(indices, indices + indexCount);
+    u32 vertexCount = u32(mesh.vertices.size());
+    if (indexCount <= targetIndexCount) {
+        return 0.0f;
+    }
+
+    // positions are scaled to the unit box so errors and attribute weights don't depend on the mesh size
+    glm::vec3 minPos = glm::vec3(FLT_MAX);
+    glm::vec3 maxPos = glm::vec3(-FLT_MAX);
+    std::vector<u8> used(vertexCount, 0);
+    for (u32 i = 0; i < indexCount; i++) {
+        used[indices[i]] = 1;
+        minPos = glm::min(minPos, mesh.vertices[indices[i]].position);
+        maxPos = glm::max(maxPos, mesh.vertices[indices[i]].position);
+    }
+    glm::vec3 size = maxPos - minPos;
+    float extent = std::max(size.x, std::max(size.y, size.z));
+    if (extent <= 0.0f) {
+        return 0.0f;
+    }
+    const auto position = [&](u32 v) {
+        return glm::dvec3((mesh.vertices[v].position - minPos) / extent);
+    };
+
+    // vertices sharing a position form a group, nextWedge links them in a ring
+    std::vector<u32> group(vertexCount, ~0u);
+    std::vector<u32> nextWedge(vertexCount, ~0u);
+    std::unordered_map<glm::vec3, u32> firstWedge;
+    firstWedge.reserve(vertexCount);
+    for (u32 v = 0; v < vertexCount; v++) {
+        if (!used[v]) {
+            continue;
+        }
+        // adding zero turns -0 into +0 so equal positions hash equally
+        auto [it, inserted] = firstWedge.try_emplace(mesh.vertices[v].position + glm::vec3(0.0f), v);
+        group[v] = it->second;
+        if (inserted) {
+            nextWedge[v] = v;
+        } else {
+            nextWedge[v] = nextWedge[it->second];
+            nextWedge[it->second] = v;
+        }
+    }
+
+    const auto edgeKey = [](u32 a, u32 b) {
+        return (u64(a) << 32) | b;
+    };
+    std::unordered_set<u64> edges;
+    std::unordered_set<u64> groupEdges;
+    edges.reserve(indexCount);
+    groupEdges.reserve(indexCount);
+    for (u32 i = 0; i < indexCount; i += 3) {
+        for (u32 k = 0; k < 3; k++) {
+            u32 a = indices[i + k];
+            u32 b = indices[i + (k + 1) % 3];
+            edges.insert(edgeKey(a, b));
+            groupEdges.insert(edgeKey(group[a], group[b]));
+        }
+    }
+
+    // open edges have no opposite half edge, they are either real borders or one side of a seam
+    std::vector<u32> openNext(vertexCount, ~0u);
+    std::vector<u32> openPrev(vertexCount, ~0u);
+    std::vector<u8> openOut(vertexCount, 0);
+    std::vector<u8> openIn(vertexCount, 0);
+    for (u32 i = 0; i < indexCount; i += 3) {
+        for (u32 k = 0; k < 3; k++) {
+            u32 a = indices[i + k];
+            u32 b = indices[i + (k + 1) % 3];
+            if (!edges.count(edgeKey(b, a))) {
+                openNext[a] = b;
+                openPrev[b] = a;
+                openOut[a] = std::min(openOut[a] + 1, 2);
+                openIn[b] = std::min(openIn[b] + 1, 2);
+            }
+        }
+    }
+
+    std::vector<VertexKind> kind(vertexCount, VertexKind::Locked);
+    for (u32 v = 0; v < vertexCount; v++) {
+        if (!used[v]) {
+            continue;
+        }
+        bool closed = openOut[v] == 0 && openIn[v] == 0;
+        bool chain = openOut[v] == 1 && openIn[v] == 1;
+        u32 w = nextWedge[v];
+        if (w == v) {
+            kind[v] = closed ? VertexKind::Manifold : chain ? VertexKind::Border : VertexKind::Locked;
+        } else if (nextWedge[w] == v && chain && openOut[w] == 1 && openIn[w] == 1
+            && group[openNext[v]] == group[openPrev[w]] && group[openPrev[v]] == group[openNext[w]]) {
+            kind[v] = VertexKind::Seam;
+        }
+    }
+
+    std::vector<Quadric> quadrics(vertexCount);
+    for (u32 i = 0; i < indexCount; i += 3) {
+        glm::dvec3 p0 = position(indices[i + 0]);
+        glm::dvec3 p1 = position(indices[i + 1]);
+        glm::dvec3 p2 = position(indices[i + 2]);
+        glm::dvec3 n = glm::cross(p1 - p0, p2 - p0);
+        double area = glm::length(n);
+        if (area <= 0.0) {
+            continue;
+        }
+        n /= area;
+        for (u32 k = 0; k < 3; k++) {
+            quadrics[group[indices[i + k]]].AddPlane(n, -glm::dot(n, p0), area * 0.5);
+        }
+        // planes perpendicular to geometric borders keep them from shrinking
+        for (u32 k = 0; k < 3; k++) {
+            u32 a = indices[i + k];
+            u32 b = indices[i + (k + 1) % 3];
+            if (groupEdges.count(edgeKey(group[b], group[a]))) {
+                continue;
+            }
+            glm::dvec3 pa = position(a);
+            glm::dvec3 edge = position(b) - pa;
+            double length = glm::length(edge);
+            if (length <= 0.0) {
+                continue;
+            }
+            glm::dvec3 borderNormal = glm::normalize(glm::cross(edge, n));
+            double d = -glm::dot(borderNormal, pa);
+            quadrics[group[a]].AddPlane(borderNormal, d, length * length * BorderWeight);
+            quadrics[group[b]].AddPlane(borderNormal, d, length * length * BorderWeight);
+        }
+    }
+
+    const auto attributeError = [&](u32 v, u32 t) {
+        const MeshVertex& a = mesh.vertices[v];
+        const MeshVertex& b = mesh.vertices[t];
+        double normal = glm::length2(a.normal - b.normal) * 0.25;
+        double uv = glm::length2(a.texCoord - b.texCoord);
+        return AttributeWeight * AttributeWeight * (normal + uv);
+    };
+    // the wedge of the seam partner that lies on the same seam edge as t
+    const auto seamTarget = [&](u32 v, u32 t) {
+        u32 partner = nextWedge[v];
+        u32 target = t == openNext[v] ? openPrev[partner] : openNext[partner];
+        return target != ~0u && group[target] == group[t] ? target : ~0u;
+    };
+    const auto canCollapse = [&](u32 v, u32 t) {
+        if (group[v] == group[t]) {
+            return false;
+        }
+        switch (kind[v]) {
+        case VertexKind::Manifold:
+            return true;
+        case VertexKind::Border:
+            return (kind[t] == VertexKind::Border || kind[t] == VertexKind::Locked) && (openNext[v] == t || openPrev[v] == t);
+        case VertexKind::Seam:
+            return (kind[t] == VertexKind::Seam || kind[t] == VertexKind::Locked) && (openNext[v] == t || openPrev[v] == t) && seamTarget(v, t) != ~0u;
+        default:
+            return false;
+        }
+    };
+
+    std::vector<u32> offsets;
+    std::vector<u32> adjacency;
+    // moving v onto t must not turn any remaining triangle around v over
+    const auto flips = [&](u32 v, u32 t) {
+        glm::dvec3 target = position(t);
+        for (u32 a = offsets[v]; a < offsets[v + 1]; a++) {
+            const u32* triangle = &output[adjacency[a] * 3];
+            if (group[triangle[0]] == group[t] || group[triangle[1]] == group[t] || group[triangle[2]] == group[t]) {
+                continue;
+            }
+            glm::dvec3 p[3] = { position(triangle[0]), position(triangle[1]), position(triangle[2]) };
+            glm::dvec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+            for (u32 k = 0; k < 3; k++) {
+                if (triangle[k] == v) {
+                    p[k] = target;
+                }
+            }
+            glm::dvec3 after = glm::cross(p[1] - p[0], p[2] - p[0]);
+            if (glm::dot(before, after) <= 0.25 * glm::length(before) * glm::length(after)) {
+                return true;
+            }
+        }
+        return false;
+    };
+    const auto removedTriangles = [&](u32 v, u32 t) {
+        u32 count = 0;
+        for (u32 a = offsets[v]; a < offsets[v + 1]; a++) {
+            const u32* triangle = &output[adjacency[a] * 3];
+            count += group[triangle[0]] == group[t] || group[triangle[1]] == group[t] || group[triangle[2]] == group[t];
+        }
+        return count;
+    };
+    const auto relinkOpen = [&](u32 v, u32 t) {
+        if (t == openNext[v]) {
+            openNext[openPrev[v]] = t;
+            openPrev[t] = openPrev[v];
+        } else {
+            openPrev[openNext[v]] = t;
+            openNext[t] = openNext[v];
+        }
+    };
+
+    struct Collapse {
+        u32 v;
+        u32 t;
+        double error;
+    };
+    std::vector<Collapse> candidates;
+    std::vector<u32> collapse(vertexCount);
+    std::vector<u8> locked(vertexCount);
+    double maxErrorSquared = double(maxError) * maxError;
+    double resultError = 0.0;
+
+    while (output.size() > targetIndexCount) {
+        u32 triangleCount = u32(output.size() / 3);
+        candidates.clear();
+        for (u32 i = 0; i < output.size(); i += 3) {
+            for (u32 k = 0; k < 3; k++) {
+                u32 a = output[i + k];
+                u32 b = output[i + (k + 1) % 3];
+                for (auto [v, t] : { std::pair(a, b), std::pair(b, a) }) {
+                    if (!canCollapse(v, t)) {
+                        continue;
+                    }
+                    Quadric q = quadrics[group[v]];
+                    q += quadrics[group[t]];
+                    double error = q.Error(position(t)) + attributeError(v, t);
+                    if (kind[v] == VertexKind::Seam) {
+                        error = std::max(error, q.Error(position(t)) + attributeError(nextWedge[v], seamTarget(v, t)));
+                    }
+                    if (error <= maxErrorSquared) {
+                        candidates.push_back({ v, t, error });
+                    }
+                }
+            }
+        }
+        if (candidates.empty()) {
+            break;
+        }
+        std::sort(candidates.begin(), candidates.end(), [](const Collapse& a, const Collapse& b) {
+            return a.error < b.error;
+        });
+
+        BuildTriangleAdjacency(output.data(), triangleCount, vertexCount, offsets, adjacency);
+        for (u32 v = 0; v < vertexCount; v++) {
+            collapse[v] = v;
+        }
+        std::fill(locked.begin(), locked.end(), 0);
+
+        // every group takes part in at most one collapse per pass, so the flip tests see the real neighborhood
+        u32 budget = triangleCount - u32(targetIndexCount / 3);
+        u32 removed = 0;
+        for (const Collapse& c : candidates) {
+            if (removed >= budget) {
+                break;
+            }
+            u32 gv = group[c.v];
+            u32 gt = group[c.t];
+            if (locked[gv] || locked[gt]) {
+                continue;
+            }
+            bool seam = kind[c.v] == VertexKind::Seam;
+            u32 partner = seam ? nextWedge[c.v] : ~0u;
+            u32 partnerTarget = seam ? seamTarget(c.v, c.t) : ~0u;
+            if (flips(c.v, c.t) || (seam && flips(partner, partnerTarget))) {
+                continue;
+            }
+            removed += removedTriangles(c.v, c.t);
+            collapse[c.v] = c.t;
+            if (seam) {
+                removed += removedTriangles(partner, partnerTarget);
+                collapse[partner] = partnerTarget;
+                relinkOpen(partner, partnerTarget);
+            }
+            if (kind[c.v] != VertexKind::Manifold) {
+                relinkOpen(c.v, c.t);
+            }
+            quadrics[gt] += quadrics[gv];
+            locked[gv] = 1;
+            locked[gt] = 1;
+            resultError = std::max(resultError, c.error);
+        }
+        if (removed == 0) {
+            break;
+        }
+
+        u32 count = 0;
+        for (u32 i = 0; i < output.size(); i += 3) {
+            u32 a = collapse[output[i + 0]];
+            u32 b = collapse[output[i + 1]];
+            u32 c = collapse[output[i + 2]];
+            if (group[a] == group[b] || group[b] == group[c] || group[a] == group[c]) {
+                continue;
+            }
+            output[count++] = a;
+            output[count++] = b;
+            output[count++] = c;
+        }
+        output.resize(count);
+    }
+    return float(std::sqrt(resultError)) * extent;
+}
+
+void GenerateLods(MeshAsset& mesh, u32 maxLods) {
+    mesh.lods.clear();
+    mesh.lods.push_back({ 0, u32(mesh.indices.size()), 0, 0, 0.0f });
+    std::vector<u32> simplified;
+    while (mesh.lods.size() < maxLods) {
+        MeshAsset::Lod previous = mesh.lods.back();
+        if (previous.indexCount / 3 < LodMinTriangles * 2) {
+            break;
+        }
+        u32 target = previous.indexCount / 6 * 3;
+        float error = Simplify(mesh, mesh.indices.data() + previous.firstIndex, previous.indexCount, target, 0.1f, simplified);
+        // stop when only locked vertices or expensive collapses are left
+        if (simplified.size() * 4 > previous.indexCount * 3) {
+            break;
+        }
+        OptimizeVertexCache(simplified, u32(mesh.vertices.size()));
+        MeshAsset::Lod lod = {};
+        lod.firstIndex = u32(mesh.indices.size());
+        lod.indexCount = u32(simplified.size());
+        // levels are simplified from the previous one, so their errors add up
+        lod.error = previous.error + error;
+        mesh.indices.insert(mesh.indices.end(), simplified.begin(), simplified.end());
+        mesh.lods.push_back(lod);
+    }
+}
+
+bool HasTangents(const MeshAsset& mesh) {
+    return std::any_of(mesh.vertices.begin(), mesh.vertices.end(), [](const MeshVertex& v) { return v.tangent.w != 0.0f; });
+}
+
+static glm::vec3 ProjectOnPlane(const glm::vec3& v, const glm::vec3& n) {
+    glm::vec3 projected = v - n * glm::dot(n, v);
+    float length = glm::length(projected);
+    return length > 1e-20f ? projected / length : glm::vec3(0.0f);
+}
+
+static glm::vec3 AnyTangent(const glm::vec3& n) {
+    glm::vec3 axis = std::abs(n.x) < 0.9f ? glm::vec3(1, 0, 0) : glm::vec3(0, 1, 0);
+    glm::vec3 t = ProjectOnPlane(axis, n);
+    return t == glm::vec3(0.0f) ? axis : t;
+}
+
+void GenerateTangents(MeshAsset& mesh) {
+    // vertices with equal position, normal and uv are one vertex for mikktspace too
+    WeldVertices(mesh);
+    u32 triangleCount = u32(mesh.indices.size() / 3);
+    u32 vertexCount = u32(mesh.vertices.size());
+    const u32* indices = mesh.indices.data();
+    const MeshVertex* vertices = mesh.vertices.data();
+
+    // per face tangent and uv orientation, 0 when the uv area is degenerate
+    std::vector<glm::vec3> faceTangents(triangleCount);
+    std::vector<i8> faceOrientation(triangleCount);
+    u32 tasks = (triangleCount + TangentBatchSize - 1) / TangentBatchSize;
+    ThreadPool::ParallelFor(tasks, [&](u32 task) {
+        u32 end = std::min(triangleCount, (task + 1) * TangentBatchSize);
+        for (u32 t = task * TangentBatchSize; t < end; t++) {
+            const MeshVertex& v0 = vertices[indices[t * 3 + 0]];
+            const MeshVertex& v1 = vertices[indices[t * 3 + 1]];
+            const MeshVertex& v2 = vertices[indices[t * 3 + 2]];
+            glm::vec3 d1 = v1.position - v0.position;
+            glm::vec3 d2 = v2.position - v0.position;
+            glm::vec2 t1 = v1.texCoord - v0.texCoord;
+            glm::vec2 t2 = v2.texCoord - v0.texCoord;
+            float signedArea = t1.x * t2.y - t1.y * t2.x;
+            glm::vec3 tangent = t2.y * d1 - t1.y * d2;
+            faceTangents[t] = signedArea < 0.0f ? -tangent : tangent;
+            faceOrientation[t] = std::abs(signedArea) > FLT_MIN && glm::length(tangent) > FLT_MIN ? (signedArea > 0.0f ? 1 : -1) : 0;
+        }
+    });
+
+    std::vector<u32> offsets;
+    std::vector<u32> adjacency;
+    BuildTriangleAdjacency(indices, triangleCount, vertexCount, offsets, adjacency);
+
+    // corners of both uv orientations are averaged apart, weighted by their angle in the tangent plane
+    std::vector<glm::vec3> positiveTangents(vertexCount);
+    std::vector<glm::vec3> negativeTangents(vertexCount);
+    std::vector<i8> vertexOrientation(vertexCount);
+    tasks = (vertexCount + TangentBatchSize - 1) / TangentBatchSize;
+    ThreadPool::ParallelFor(tasks, [&](u32 task) {
+        u32 end = std::min(vertexCount, (task + 1) * TangentBatchSize);
+        for (u32 v = task * TangentBatchSize; v < end; v++) {
+            glm::vec3 n = vertices[v].normal;
+            glm::vec3 positive = glm::vec3(0.0f);
+            glm::vec3 negative = glm::vec3(0.0f);
+            float positiveWeight = 0.0f;
+            float negativeWeight = 0.0f;
+            for (u32 i = offsets[v]; i < offsets[v + 1]; i++) {
+                u32 t = adjacency[i];
+                if (faceOrientation[t] == 0) {
+                    continue;
+                }
+                u32 k = indices[t * 3 + 0] == v ? 0 : indices[t * 3 + 1] == v ? 1 : 2;
+                const glm::vec3& p = vertices[v].position;
+                glm::vec3 e0 = ProjectOnPlane(vertices[indices[t * 3 + (k + 1) % 3]].position - p, n);
+                glm::vec3 e1 = ProjectOnPlane(vertices[indices[t * 3 + (k + 2) % 3]].position - p, n);
+                float angle = std::acos(glm::clamp(glm::dot(e0, e1), -1.0f, 1.0f));
+                glm::vec3 tangent = ProjectOnPlane(faceTangents[t], n) * angle;
+                if (faceOrientation[t] > 0) {
+                    positive += tangent;
+                    positiveWeight += angle;
+                } else {
+                    negative += tangent;
+                    negativeWeight += angle;
+                }
+            }
+            positiveTangents[v] = positive;
+            negativeTangents[v] = negative;
+            vertexOrientation[v] = positiveWeight > 0.0f && negativeWeight > 0.0f ? 2 : negativeWeight > positiveWeight ? -1 : 1;
+        }
+    });
+
+    // vertices on a mirrored uv seam are split, the negative side gets a copy of the vertex
+    std::vector<u32> mirrored(vertexCount, ~0u);
+    for (u32 v = 0; v < vertexCount; v++) {
+        if (vertexOrientation[v] == 2) {
+            mirrored[v] = u32(mesh.vertices.size());
+            mesh.vertices.push_back(mesh.vertices[v]);
+        }
+    }
+    const auto finish = [](MeshVertex& vertex, const glm::vec3& tangent, float sign) {
+        float length = glm::length(tangent);
+        vertex.tangent = glm::vec4(length > 1e-20f ? tangent / length : AnyTangent(vertex.normal), sign);
+    };
+    ThreadPool::ParallelFor(tasks, [&](u32 task) {
+        u32 end = std::min(vertexCount, (task + 1) * TangentBatchSize);
+        for (u32 v = task * TangentBatchSize; v < end; v++) {
+            MeshVertex& vertex = mesh.vertices[v];
+            if (vertexOrientation[v] == 2) {
+                finish(vertex, positiveTangents[v], 1.0f);
+                finish(mesh.vertices[mirrored[v]], negativeTangents[v], -1.0f);
+            } else if (vertexOrientation[v] < 0) {
+                finish(vertex, negativeTangents[v], -1.0f);
+            } else {
+                finish(vertex, positiveTangents[v], 1.0f);
+            }
+        }
+    });
+    ThreadPool::ParallelFor((triangleCount + TangentBatchSize - 1) / TangentBatchSize, [&](u32 task) {
+        u32 end = std::min(triangleCount, (task + 1) * TangentBatchSize);
+        for (u32 t = task * TangentBatchSize; t < end; t++) {
+            if (faceOrientation[t] >= 0) {
+                continue;
+            }
+            for (u32 k = 0; k < 3; k++) {
+                u32& index = mesh.indices[t * 3 + k];
+                if (index < vertexCount && mirrored[index] != ~0u) {
+                    index = mirrored[index];
+                }
+            }
+        }
+    });
+}
+
+// 16 byte loads of a position also read the first normal component, that lane is ignored
+static_assert(offsetof(MeshVertex, normal) == sizeof(glm::vec3));
+
+static void PositionRange(const std::vector<MeshVertex>& vertices, glm::vec3& minPos, glm::vec3& maxPos) {
+    size_t i = 0;
+    minPos = glm::vec3(FLT_MAX);
+    maxPos = glm::vec3(-FLT_MAX);
+#ifdef LUZ_SSE
+    // two independent accumulators hide the min/max latency
+    __m128 min0 = _mm_set1_ps(FLT_MAX);
+    __m128 max0 = _mm_set1_ps(-FLT_MAX);
+    __m128 min1 = min0;
+    __m128 max1 = max0;
+    for (; i + 2 <= vertices.size(); i += 2) {
+        __m128 p0 = _mm_loadu_ps(&vertices[i].position.x);
+        __m128 p1 = _mm_loadu_ps(&vertices[i + 1].position.x);
+        min0 = _mm_min_ps(min0, p0);
+        max0 = _mm_max_ps(max0, p0);
+        min1 = _mm_min_ps(min1, p1);
+        max1 = _mm_max_ps(max1, p1);
+    }
+    alignas(16) float lo[4];
+    alignas(16) float hi[4];
+    _mm_store_ps(lo, _mm_min_ps(min0, min1));
+    _mm_store_ps(hi, _mm_max_ps(max0, max1));
+    minPos = glm::vec3(lo[0], lo[1], lo[2]);
+    maxPos = glm::vec3(hi[0], hi[1], hi[2]);
+#endif
+    for (; i < vertices.size(); i++) {
+        minPos = glm::min(minPos, vertices[i].position);
+        maxPos = glm::max(maxPos, vertices[i].position);
+    }
+}
+
+static float MaxDistanceSquared(const std::vector<MeshVertex>& vertices, glm::vec3 center) {
+    size_t i = 0;
+    float result = 0.0f;
+#ifdef LUZ_SSE
+    // four positions transposed into x, y and z lanes per iteration
+    const __m128 cx = _mm_set1_ps(center.x);
+    const __m128 cy = _mm_set1_ps(center.y);
+    const __m128 cz = _mm_set1_ps(center.z);
+    __m128 maxDistance = _mm_setzero_ps();
+    for (; i + 4 <= vertices.size(); i += 4) {
+        __m128 x = _mm_loadu_ps(&vertices[i + 0].position.x);
+        __m128 y = _mm_loadu_ps(&vertices[i + 1].position.x);
+        __m128 z = _mm_loadu_ps(&vertices[i + 2].position.x);
+        __m128 w = _mm_loadu_ps(&vertices[i + 3].position.x);
+        _MM_TRANSPOSE4_PS(x, y, z, w);
+        __m128 dx = _mm_sub_ps(x, cx);
+        __m128 dy = _mm_sub_ps(y, cy);
+        __m128 dz = _mm_sub_ps(z, cz);
+        __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+        maxDistance = _mm_max_ps(maxDistance, distance);
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, maxDistance);
+    result = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+#endif
+    for (; i < vertices.size(); i++) {
+        glm::vec3 d = vertices[i].position - center;
+        result = std::max(result, glm::dot(d, d));
+    }
+    return result;
+}
+
+void ComputeBounds(MeshAsset& mesh) {
+    if (mesh.vertices.empty()) {
+        mesh.aabbMin = mesh.aabbMax = mesh.sphereCenter = glm::vec3(0.0f);
+        mesh.sphereRadius = 0.0f;
+        return;
+    }
+    PositionRange(mesh.vertices, mesh.aabbMin, mesh.aabbMax);
+    mesh.sphereCenter = (mesh.aabbMin + mesh.aabbMax) * 0.5f;
+    mesh.sphereRadius = std::sqrt(MaxDistanceSquared(mesh.vertices, mesh.sphereCenter));
+}
+
+static i16 PackSnorm(float v) {
+    return i16(std::round(glm::clamp(v, -1.0f, 1.0f) * 32767.0f));
+}
+
+static glm::vec2 OctEncode(glm::vec3 n) {
+    n /= std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+    glm::vec2 e = glm::vec2(n.x, n.y);
+    if (n.z < 0.0f) {
+        e.x = (1.0f - std::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f);
+        e.y = (1.0f - std::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f);
+    }
+    return e;
+}
+
+std::vector<u32> SplitSpatially(const std::vector<glm::vec3>& positions, const std::vector<u32>& indices, u32 maxTriangles, std::vector<u32>& triangles) {
+    LUZ_PROFILE_NAMED("MeshProcessing::SplitSpatially");
+    u32 triangleCount = u32(indices.size() / 3);
+    triangles.resize(triangleCount);
+    for (u32 i = 0; i < triangleCount; i++) {
+        triangles[i] = i;
+    }
+    maxTriangles = std::max(maxTriangles, 1u);
+    // three times the centroid, only used for comparisons
+    const auto centroid = [&](u32 t) {
+        return positions[indices[t * 3 + 0]] + positions[indices[t * 3 + 1]] + positions[indices[t * 3 + 2]];
+    };
+    struct Part {
+        u32 begin;
+        u32 end;
+    };
+    std::vector<Part> pending;
+    std::vector<Part> parts;
+    (triangleCount > maxTriangles ? pending : parts).push_back({ 0, triangleCount });
+    // every level splits all of its parts at once
+    while (!pending.empty()) {
+        std::vector<Part> halves(pending.size() * 2);
+        ThreadPool::ParallelFor(u32(pending.size()), [&](u32 p) {
+            u32* first = triangles.data() + pending[p].begin;
+            u32* last = triangles.data() + pending[p].end;
+            glm::vec3 lo(FLT_MAX);
+            glm::vec3 hi(-FLT_MAX);
+            for (u32* t = first; t < last; t++) {
+                glm::vec3 c = centroid(*t);
+                lo = glm::min(lo, c);
+                hi = glm::max(hi, c);
+            }
+            glm::vec3 extent = hi - lo;
+            int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : extent.y >= extent.z ? 1 : 2;
+            float middle = (lo[axis] + hi[axis]) * 0.5f;
+            u32* split = std::partition(first, last, [&](u32 t) {
+                return centroid(t)[axis] < middle;
+            });
+            // coincident centroids or far outliers leave one side empty, the median always splits
+            if (split == first || split == last) {
+                split = first + (last - first) / 2;
+                std::nth_element(first, split, last, [&](u32 a, u32 b) {
+                    return centroid(a)[axis] < centroid(b)[axis];
+                });
+            }
+            u32 middleIndex = u32(split - triangles.data());
+            halves[p * 2 + 0] = { pending[p].begin, middleIndex };
+            halves[p * 2 + 1] = { middleIndex, pending[p].end };
+        });
+        pending.clear();
+        for (const Part& half : halves) {
+            (half.end - half.begin > maxTriangles ? pending : parts).push_back(half);
+        }
+    }
+    std::sort(parts.begin(), parts.end(), [](const Part& a, const Part& b) {
+        return a.begin < b.begin;
+    });
+    std::vector<u32> offsets;
+    for (const Part& part : parts) {
+        offsets.push_back(part.begin);
+    }
+    offsets.push_back(triangleCount);
+    return offsets;
+}
+
+void PackVertices(const MeshAsset& mesh, std::vector<MeshAsset::PackedVertex>& packed, glm::vec3& offset, float& scale) {
+    glm::vec3 minPos;
+    glm::vec3 maxPos;
+    PositionRange(mesh.vertices, minPos, maxPos);
+    // a single scale keeps the dequantization uniform, so it can be folded into the model matrix
+    offset = mesh.vertices.empty() ? glm::vec3(0.0f) : (minPos + maxPos) * 0.5f;
+    glm::vec3 halfSize = mesh.vertices.empty() ? glm::vec3(0.0f) : (maxPos - minPos) * 0.5f;
+    scale = std::max(std::max(halfSize.x, halfSize.y), std::max(halfSize.z, FLT_MIN));
+
+    packed.resize(mesh.vertices.size());
+    for (size_t i = 0; i < mesh.vertices.size(); i++) {
+        const MeshVertex& v = mesh.vertices[i];
+        MeshAsset::PackedVertex& p = packed[i];
+        glm::vec3 position = (v.position - offset) / scale;
+        p.position[0] = PackSnorm(position.x);
+        p.position[1] = PackSnorm(position.y);
+        p.position[2] = PackSnorm(position.z);
+        p.position[3] = v.tangent.w < 0.0f ? -32767 : 32767;
+        float normalLength = glm::length(v.normal);
+        glm::vec2 normal = OctEncode(normalLength > 0.0f ? v.normal / normalLength : glm::vec3(0, 0, 1));
+        float tangentLength = glm::length(glm::vec3(v.tangent));
+        glm::vec2 tangent = OctEncode(tangentLength > 0.0f ? glm::vec3(v.tangent) / tangentLength : glm::vec3(1, 0, 0));
+        p.normalTangent[0] = PackSnorm(normal.x);
+        p.normalTangent[1] = PackSnorm(normal.y);
+        p.normalTangent[2] = PackSnorm(tangent.x);
+        p.normalTangent[3] = PackSnorm(tangent.y);
+        p.texCoord[0] = u16(glm::packHalf1x16(v.texCoord.x));
+        p.texCoord[1] = u16(glm::packHalf1x16(v.texCoord.y));
+    }
+}
+
+void Optimize(MeshAsset& mesh, VertexCacheStats& before, VertexCacheStats& after) {
+    before = AnalyzeVertexCache(mesh.indices, u32(mesh.vertices.size()));
+    WeldVertices(mesh);
+    RemoveDegenerateTriangles(mesh);
+    std::vector<u32> boundaries = OptimizeVertexCache(mesh.indices, u32(mesh.vertices.size()));
+    OptimizeOverdraw(mesh, boundaries);
+    OptimizeVertexFetch(mesh);
+    after = AnalyzeVertexCache(mesh.indices, u32(mesh.vertices.size()));
+}
+
+}
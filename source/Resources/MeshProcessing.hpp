@@ -0,0 +1,82 @@
+#pragma once
+
+#include "AssetManager.hpp"
+
+namespace MeshProcessing {
+
+// open addressing table of vertex indices, linear probing on a 64 bit hash of all vertex attributes
+struct VertexTable {
+    std::vector<u32> slots;
+    u32 mask = 0;
+
+    VertexTable(size_t expectedVertices);
+    u32 Insert(const MeshAsset::MeshVertex& vertex, std::vector<MeshAsset::MeshVertex>& vertices);
+
+private:
+    void Grow(const std::vector<MeshAsset::MeshVertex>& vertices);
+};
+
+struct VertexCacheStats {
+    u32 triangles = 0;
+    u32 vertices = 0;
+    u32 misses = 0;
+
+    // average cache miss ratio, transformed vertices per triangle
+    float ACMR() const { return triangles ? float(misses) / triangles : 0.0f; }
+    // average transform to vertex ratio, 1.0 means every vertex is transformed once
+    float ATVR() const { return vertices ? float(misses) / vertices : 0.0f; }
+
+    VertexCacheStats& operator+=(const VertexCacheStats& rhs) {
+        triangles += rhs.triangles;
+        vertices += rhs.vertices;
+        misses += rhs.misses;
+        return *this;
+    }
+};
+
+inline constexpr u32 VertexCacheSize = 16;
+inline constexpr u32 MeshletMaxVertices = 64;
+inline constexpr u32 MeshletMaxTriangles = 124;
+inline constexpr u32 MaxLodCount = 8;
+inline constexpr u32 LodMinTriangles = 64;
+inline constexpr u32 TangentBatchSize = 16384;
+
+VertexCacheStats AnalyzeVertexCache(const std::vector<u32>& indices, u32 vertexCount, u32 cacheSize = VertexCacheSize);
+
+void WeldVertices(MeshAsset& mesh);
+void RemoveDegenerateTriangles(MeshAsset& mesh);
+// tipsify, returns the first triangle of every cluster that starts after a cache flush
+std::vector<u32> OptimizeVertexCache(std::vector<u32>& indices, u32 vertexCount, u32 cacheSize = VertexCacheSize);
+void OptimizeOverdraw(MeshAsset& mesh, const std::vector<u32>& hardBoundaries, float threshold = 1.05f);
+void OptimizeVertexFetch(MeshAsset& mesh);
+
+// reorders indices[firstIndex, firstIndex + indexCount) so that every appended meshlet is a contiguous range
+void BuildMeshlets(MeshAsset& mesh, u32 firstIndex, u32 indexCount, std::vector<MeshAsset::Meshlet>& meshlets, u32 maxVertices = MeshletMaxVertices, u32 maxTriangles = MeshletMaxTriangles);
+
+// quadric error edge collapse of indices until targetIndexCount is reached or the next collapse would move the surface
+// further than maxError, relative to the mesh extent. uv seams and hard normals are only collapsed along themselves and
+// normal/uv changes add to the error. The output only references existing vertices, returns the object space error
+float Simplify(const MeshAsset& mesh, const u32* indices, u32 indexCount, u32 targetIndexCount, float maxError, std::vector<u32>& output);
+// treats mesh.indices as lod 0 and appends every simplified level to it, each level halves the triangle count
+void GenerateLods(MeshAsset& mesh, u32 maxLods = MaxLodCount);
+
+bool HasTangents(const MeshAsset& mesh);
+// mikktspace style tangents: per face uv tangents projected on the vertex normal and weighted by the corner angle.
+// Faces with mirrored uvs don't share tangents, vertices on a mirror seam are split
+void GenerateTangents(MeshAsset& mesh);
+
+// simd reduction of the positions into the mesh aabb and bounding sphere
+void ComputeBounds(MeshAsset& mesh);
+
+// partitions the triangles of indices at the middle of their centroid bounds, longest axis first, until no part
+// holds more than maxTriangles. triangles receives the triangle ids grouped by part, the returned offsets delimit
+// the parts and end with the triangle count
+std::vector<u32> SplitSpatially(const std::vector<glm::vec3>& positions, const std::vector<u32>& indices, u32 maxTriangles, std::vector<u32>& triangles);
+
+// quantizes vertices to MeshAsset::PackedVertex, the object space position is offset + position * scale
+void PackVertices(const MeshAsset& mesh, std::vector<MeshAsset::PackedVertex>& packed, glm::vec3& offset, float& scale);
+
+// runs the cleanup and ordering steps above, stats are measured on the input and on the output
+void Optimize(MeshAsset& mesh, VertexCacheStats& before, VertexCacheStats& after);
+
+}
@@ -0,0 +1,380 @@
+#include "Luzpch.hpp"
+
+#include "OcclusionBaking.hpp"
+#include "ThreadPool.hpp"
+#include "Util.hpp"
+
+#include <unordered_set>
+
+namespace OcclusionBaking {
+
+// a vertex and the two edges leaving it, what the intersection test reads
+struct Triangle {
+    glm::vec3 v0;
+    glm::vec3 e1;
+    glm::vec3 e2;
+};
+
+// inner nodes store their two children next to each other at first, leaves own count triangles from first
+struct BvhNode {
+    glm::vec3 min;
+    u32 first;
+    glm::vec3 max;
+    u32 count;
+};
+
+struct Bvh {
+    std::vector<BvhNode> nodes;
+    std::vector<Triangle> triangles;
+};
+
+struct Bounds {
+    glm::vec3 min = glm::vec3(FLT_MAX);
+    glm::vec3 max = glm::vec3(-FLT_MAX);
+
+    void Grow(const glm::vec3& p) {
+        min = glm::min(min, p);
+        max = glm::max(max, p);
+    }
+
+    void Grow(const Bounds& b) {
+        min = glm::min(min, b.min);
+        max = glm::max(max, b.max);
+    }
+
+    float HalfArea() const {
+        glm::vec3 e = glm::max(max - min, glm::vec3(0.0f));
+        return e.x * e.y + e.y * e.z + e.z * e.x;
+    }
+};
+
+inline constexpr u32 BinCount = 16;
+inline constexpr u32 MaxLeafTriangles = 4;
+// deeper nodes become leaves, which bounds the traversal stack
+inline constexpr u32 MaxDepth = 64;
+
+// binned surface area heuristic over the triangle centroids, splits along the longest centroid axis
+static Bvh BuildBvh(std::vector<Triangle>& triangles) {
+    LUZ_PROFILE_NAMED("OcclusionBaking::BuildBvh");
+    Bvh bvh;
+    u32 count = u32(triangles.size());
+    if (count == 0) {
+        return bvh;
+    }
+    std::vector<Bounds> bounds(count);
+    std::vector<glm::vec3> centroids(count);
+    ThreadPool::ParallelFor((count + 4095) / 4096, [&](u32 chunk) {
+        for (u32 i = chunk * 4096; i < std::min(count, (chunk + 1) * 4096); i++) {
+            const Triangle& t = triangles[i];
+            bounds[i].Grow(t.v0);
+            bounds[i].Grow(t.v0 + t.e1);
+            bounds[i].Grow(t.v0 + t.e2);
+            centroids[i] = (bounds[i].min + bounds[i].max) * 0.5f;
+        }
+    });
+    std::vector<u32> order(count);
+    for (u32 i = 0; i < count; i++) {
+        order[i] = i;
+    }
+    struct Task {
+        u32 node;
+        u32 depth;
+    };
+    bvh.nodes.push_back({ glm::vec3(0.0f), 0, glm::vec3(0.0f), count });
+    std::vector<Task> stack = { { 0, 0 } };
+    while (!stack.empty()) {
+        Task task = stack.back();
+        stack.pop_back();
+        u32 first = bvh.nodes[task.node].first;
+        u32 nodeCount = bvh.nodes[task.node].count;
+        Bounds nodeBounds;
+        Bounds centroidBounds;
+        for (u32 i = first; i < first + nodeCount; i++) {
+            nodeBounds.Grow(bounds[order[i]]);
+            centroidBounds.Grow(centroids[order[i]]);
+        }
+        bvh.nodes[task.node].min = nodeBounds.min;
+        bvh.nodes[task.node].max = nodeBounds.max;
+        if (nodeCount <= MaxLeafTriangles || task.depth >= MaxDepth) {
+            continue;
+        }
+        glm::vec3 extent = centroidBounds.max - centroidBounds.min;
+        int axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+        if (extent[axis] <= 0.0f) {
+            continue;
+        }
+        float scale = BinCount / extent[axis];
+        const auto binOf = [&](u32 triangle) {
+            return std::min(BinCount - 1, u32((centroids[triangle][axis] - centroidBounds.min[axis]) * scale));
+        };
+        Bounds binBounds[BinCount];
+        u32 binCounts[BinCount] = {};
+        for (u32 i = first; i < first + nodeCount; i++) {
+            u32 bin = binOf(order[i]);
+            binBounds[bin].Grow(bounds[order[i]]);
+            binCounts[bin]++;
+        }
+        // cost of splitting after every bin, the right side is swept back to front
+        float rightCost[BinCount] = {};
+        Bounds right;
+        u32 rightCount = 0;
+        for (u32 b = BinCount - 1; b > 0; b--) {
+            right.Grow(binBounds[b]);
+            rightCount += binCounts[b];
+            rightCost[b - 1] = rightCount ? right.HalfArea() * rightCount : 0.0f;
+        }
+        Bounds left;
+        u32 leftCount = 0;
+        float bestCost = FLT_MAX;
+        u32 bestSplit = 0;
+        for (u32 b = 0; b + 1 < BinCount; b++) {
+            left.Grow(binBounds[b]);
+            leftCount += binCounts[b];
+            if (leftCount == 0 || leftCount == nodeCount) {
+                continue;
+            }
+            float cost = left.HalfArea() * leftCount + rightCost[b];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestSplit = b;
+            }
+        }
+        if (bestCost == FLT_MAX) {
+            continue;
+        }
+        u32* middle = std::partition(order.data() + first, order.data() + first + nodeCount, [&](u32 triangle) {
+            return binOf(triangle) <= bestSplit;
+        });
+        u32 split = u32(middle - order.data());
+        u32 children = u32(bvh.nodes.size());
+        bvh.nodes[task.node].first = children;
+        bvh.nodes[task.node].count = 0;
+        bvh.nodes.push_back({ glm::vec3(0.0f), first, glm::vec3(0.0f), split - first });
+        bvh.nodes.push_back({ glm::vec3(0.0f), split, glm::vec3(0.0f), first + nodeCount - split });
+        stack.push_back({ children, task.depth + 1 });
+        stack.push_back({ children + 1, task.depth + 1 });
+    }
+    bvh.triangles.resize(count);
+    for (u32 i = 0; i < count; i++) {
+        bvh.triangles[i] = triangles[order[i]];
+    }
+    return bvh;
+}
+
+static bool HitsBox(const BvhNode& node, const glm::vec3& origin, const glm::vec3& invDirection, float tMin, float tMax) {
+    glm::vec3 t0 = (node.min - origin) * invDirection;
+    glm::vec3 t1 = (node.max - origin) * invDirection;
+    glm::vec3 tNear = glm::min(t0, t1);
+    glm::vec3 tFar = glm::max(t0, t1);
+    float enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, tMin));
+    float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, tMax));
+    return enter <= exit;
+}
+
+// Moller-Trumbore, both faces occlude
+static bool HitsTriangle(const Triangle& t, const glm::vec3& origin, const glm::vec3& direction, float tMin, float tMax) {
+    glm::vec3 p = glm::cross(direction, t.e2);
+    float det = glm::dot(t.e1, p);
+    if (det == 0.0f) {
+        return false;
+    }
+    float invDet = 1.0f / det;
+    glm::vec3 s = origin - t.v0;
+    float u = glm::dot(s, p) * invDet;
+    if (u < 0.0f || u > 1.0f) {
+        return false;
+    }
+    glm::vec3 q = glm::cross(s, t.e1);
+    float v = glm::dot(direction, q) * invDet;
+    if (v < 0.0f || u + v > 1.0f) {
+        return false;
+    }
+    float distance = glm::dot(t.e2, q) * invDet;
+    return distance > tMin && distance < tMax;
+}
+
+// any hit query, stops at the first triangle found in range
+static bool Occluded(const Bvh& bvh, const glm::vec3& origin, const glm::vec3& direction, float tMin, float tMax) {
+    if (bvh.nodes.empty()) {
+        return false;
+    }
+    // axis parallel rays would multiply 0 by infinity in the slab test
+    glm::vec3 safeDirection = glm::mix(direction, glm::vec3(1e-20f), glm::lessThan(glm::abs(direction), glm::vec3(1e-20f)));
+    glm::vec3 invDirection = 1.0f / safeDirection;
+    u32 stack[MaxDepth * 2 + 2];
+    u32 size = 0;
+    stack[size++] = 0;
+    while (size) {
+        const BvhNode& node = bvh.nodes[stack[--size]];
+        if (!HitsBox(node, origin, invDirection, tMin, tMax)) {
+            continue;
+        }
+        if (node.count) {
+            for (u32 i = node.first; i < node.first + node.count; i++) {
+                if (HitsTriangle(bvh.triangles[i], origin, direction, tMin, tMax)) {
+                    return true;
+                }
+            }
+        } else {
+            stack[size++] = node.first;
+            stack[size++] = node.first + 1;
+        }
+    }
+    return false;
+}
+
+Settings SceneSettings(const SceneAsset& scene) {
+    Settings settings;
+    settings.samples = u32(std::max(scene.aoBakeSamples, 1));
+    settings.minDistance = scene.aoMin;
+    settings.maxDistance = scene.aoMax;
+    return settings;
+}
+
+// a static node in world space, its vertices receive occlusion and its lod 0 triangles occlude
+struct Receiver {
+    Ref<MeshNode> node;
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> normals;
+    // offset along the normal that keeps rays from hitting the faces around their own vertex
+    float bias = 0.0f;
+    u32 firstTriangle = 0;
+    u32 triangleCount = 0;
+};
+
+Stats Bake(AssetManager& manager, const Ref<SceneAsset>& scene, const Settings& settings) {
+    LUZ_PROFILE_NAMED("OcclusionBaking::Bake");
+    auto start = std::chrono::high_resolution_clock::now();
+    Stats stats;
+    std::vector<Ref<MeshNode>> nodes = scene->GetAll<MeshNode>(ObjectType::MeshNode);
+    std::unordered_map<UUID, u32> users;
+    std::unordered_map<UUID, u32> staticUsers;
+    for (const Ref<MeshNode>& node : nodes) {
+        if (node->mesh) {
+            users[node->mesh->uuid]++;
+            staticUsers[node->mesh->uuid] += node->isStatic;
+        }
+    }
+
+    std::vector<Receiver> receivers;
+    std::unordered_set<UUID> kept;
+    for (const Ref<MeshNode>& node : nodes) {
+        if (!node->isStatic || !node->mesh || !manager.MakeResident(node->mesh) || node->mesh->indices.empty()) {
+            continue;
+        }
+        // the first static node keeps a shared mesh unless a dynamic node draws it too
+        UUID uuid = node->mesh->uuid;
+        if (users[uuid] > 1 && (staticUsers[uuid] < users[uuid] || kept.count(uuid))) {
+            node->mesh = manager.CloneAsset<MeshAsset>(node->mesh);
+            stats.clonedMeshes++;
+        } else {
+            kept.insert(uuid);
+        }
+        receivers.emplace_back().node = node;
+    }
+    // meshes left to dynamic nodes drop the values baked for a static placement
+    std::unordered_set<UUID> baked;
+    for (const Receiver& receiver : receivers) {
+        baked.insert(receiver.node->mesh->uuid);
+    }
+    for (const Ref<MeshNode>& node : nodes) {
+        const Ref<MeshAsset>& mesh = node->mesh;
+        if (mesh && !baked.count(mesh->uuid) && !mesh->occlusion.empty() && manager.MakeResident(mesh)) {
+            mesh->occlusion.clear();
+            manager.MarkModified(mesh);
+        }
+    }
+
+    ThreadPool::ParallelFor(u32(receivers.size()), [&](u32 i) {
+        Receiver& receiver = receivers[i];
+        const MeshAsset& mesh = *receiver.node->mesh;
+        glm::mat4 transform = receiver.node->GetWorldTransform();
+        glm::mat3 normalMat = glm::transpose(glm::inverse(glm::mat3(transform)));
+        receiver.positions.resize(mesh.vertices.size());
+        receiver.normals.resize(mesh.vertices.size());
+        Bounds bounds;
+        for (size_t v = 0; v < mesh.vertices.size(); v++) {
+            receiver.positions[v] = transform * glm::vec4(mesh.vertices[v].position, 1.0f);
+            glm::vec3 normal = normalMat * mesh.vertices[v].normal;
+            receiver.normals[v] = glm::length(normal) > 0.0f ? glm::normalize(normal) : normal;
+            bounds.Grow(receiver.positions[v]);
+        }
+        receiver.bias = glm::length(bounds.max - bounds.min) * 1e-4f;
+        receiver.triangleCount = u32(mesh.lods.empty() ? mesh.indices.size() : mesh.lods[0].indexCount) / 3;
+    });
+    u32 triangleCount = 0;
+    for (Receiver& receiver : receivers) {
+        receiver.firstTriangle = triangleCount;
+        triangleCount += receiver.triangleCount;
+        stats.vertices += receiver.positions.size();
+    }
+    std::vector<Triangle> triangles(triangleCount);
+    ThreadPool::ParallelFor(u32(receivers.size()), [&](u32 i) {
+        const Receiver& receiver = receivers[i];
+        const MeshAsset& mesh = *receiver.node->mesh;
+        u32 firstIndex = mesh.lods.empty() ? 0 : mesh.lods[0].firstIndex;
+        for (u32 t = 0; t < receiver.triangleCount; t++) {
+            const u32* index = &mesh.indices[firstIndex + t * 3];
+            glm::vec3 v0 = receiver.positions[index[0]];
+            triangles[receiver.firstTriangle + t] = { v0, receiver.positions[index[1]] - v0, receiver.positions[index[2]] - v0 };
+        }
+    });
+    Bvh bvh = BuildBvh(triangles);
+    triangles = {};
+
+    // cosine distributed directions around +z, every vertex rotates the whole set by its own random offset
+    std::vector<glm::vec2> sequence(settings.samples);
+    for (u32 i = 0; i < settings.samples; i++) {
+        sequence[i] = glm::vec2(Halton(i + 1, 2), Halton(i + 1, 3));
+    }
+    const u32 chunkSize = 64;
+    struct Chunk {
+        u32 receiver;
+        u32 first;
+    };
+    std::vector<Chunk> chunks;
+    for (u32 r = 0; r < receivers.size(); r++) {
+        receivers[r].node->mesh->occlusion.resize(receivers[r].positions.size());
+        for (u32 v = 0; v < receivers[r].positions.size(); v += chunkSize) {
+            chunks.push_back({ r, v });
+        }
+    }
+    ThreadPool::ParallelFor(u32(chunks.size()), [&](u32 c) {
+        const Receiver& receiver = receivers[chunks[c].receiver];
+        std::vector<u8>& occlusion = receiver.node->mesh->occlusion;
+        u32 last = std::min(u32(receiver.positions.size()), chunks[c].first + chunkSize);
+        for (u32 v = chunks[c].first; v < last; v++) {
+            const glm::vec3& normal = receiver.normals[v];
+            if (glm::length(normal) == 0.0f) {
+                occlusion[v] = 255;
+                continue;
+            }
+            glm::vec3 tangent = glm::normalize(glm::abs(normal.z) > 0.5f ? glm::vec3(0.0f, -normal.z, normal.y) : glm::vec3(-normal.y, normal.x, 0.0f));
+            glm::vec3 bitangent = glm::cross(normal, tangent);
+            glm::vec3 origin = receiver.positions[v] + normal * receiver.bias;
+            u64 seed = HashMix64((u64(chunks[c].receiver) << 32) | v);
+            glm::vec2 offset = glm::vec2(float(seed & 0xffffff), float((seed >> 24) & 0xffffff)) / 16777216.0f;
+            u32 unoccluded = 0;
+            for (const glm::vec2& sample : sequence) {
+                glm::vec2 rng = glm::fract(sample + offset);
+                float radius = glm::sqrt(rng.x);
+                float theta = 2.0f * glm::pi<float>() * rng.y;
+                glm::vec3 direction = tangent * (radius * glm::cos(theta)) + bitangent * (radius * glm::sin(theta)) + normal * glm::sqrt(glm::max(0.0f, 1.0f - rng.x));
+                unoccluded += !Occluded(bvh, origin, direction, settings.minDistance, settings.maxDistance);
+            }
+            occlusion[v] = u8(glm::round(255.0f * unoccluded / settings.samples));
+        }
+    });
+    for (const Receiver& receiver : receivers) {
+        manager.MarkModified(receiver.node->mesh);
+    }
+
+    stats.nodes = u32(receivers.size());
+    stats.triangles = triangleCount;
+    stats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+    LOG_INFO("Baked ambient occlusion of {} vertices on {} static nodes against {} triangles in {:.1f} ms, {} meshes copied",
+        stats.vertices, stats.nodes, stats.triangles, stats.milliseconds, stats.clonedMeshes);
+    return stats;
+}
+
+}
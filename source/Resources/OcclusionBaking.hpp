@@ -0,0 +1,34 @@
+#pragma once
+
+#include "AssetManager.hpp"
+
+// Offline ambient occlusion of static geometry, traced on the cpu against a BVH so it also runs on machines
+// without a gpu. The light pass uses the baked value instead of tracing ao rays for those pixels.
+namespace OcclusionBaking {
+
+struct Settings {
+    u32 samples = 256;
+    // rays start minDistance away from the vertex and only hits closer than maxDistance occlude it,
+    // the same range SceneAsset::aoMin and aoMax give the rays traced at runtime
+    float minDistance = 0.0001f;
+    float maxDistance = 1.0f;
+};
+
+struct Stats {
+    u32 nodes = 0;
+    u64 vertices = 0;
+    u64 triangles = 0;
+    // meshes copied because other nodes of the scene use them too
+    u32 clonedMeshes = 0;
+    double milliseconds = 0.0;
+};
+
+Settings SceneSettings(const SceneAsset& scene);
+
+// traces cosine distributed hemisphere rays from every vertex of the static mesh nodes of the scene against
+// all static geometry and stores the unoccluded fraction in MeshAsset::occlusion. ao depends on where a node is,
+// so a static node gets its own copy of a mesh other nodes also use, and meshes only used by dynamic nodes
+// lose their baked values
+Stats Bake(AssetManager& manager, const Ref<SceneAsset>& scene, const Settings& settings);
+
+}
@@ -3,6 +3,9 @@
 #include "Base.hpp"
 #include <json.hpp>
 #include "AssetManager.hpp"
+#include "AssetIO.hpp"
+
+#include <functional>
 
 using Json = nlohmann::json;
 
@@ -31,18 +34,26 @@ inline void from_json(const Json& j, glm::vec3& v) {
     }
 }
 
+// written into data when saving, read from the mapped file when loading
 struct BinaryStorage {
     std::vector<u8> data;
+    Ref<AssetIO::MappedFile> file;
+    // loading work that only needs the bytes, run in parallel once every object is read
+    std::vector<std::function<void()>> deferred;
 
-    uint32_t Push(void* ptr, uint32_t size) {
-        uint32_t offset = data.size();
+    u64 Push(const void* ptr, u64 size) {
+        u64 offset = data.size();
         data.resize(data.size() + size);
         memcpy(data.data() + offset, ptr, size);
         return offset;
     }
 
-    void* Get(uint32_t offset) {
-        return data.data() + offset;
+    const u8* Get(u64 offset) const {
+        return (file ? file->data : data.data()) + offset;
+    }
+
+    u64 Size() const {
+        return file ? file->size : data.size();
     }
 };
 
@@ -93,21 +104,40 @@ struct Serializer {
     template<typename T>
     void Vector(const std::string& field, std::vector<T>& v) {
         if (dir == SAVE) {
-            uint32_t size = v.size() * sizeof(T);
-            uint32_t offset = storage.Push(v.data(), size);
+            u64 size = v.size() * sizeof(T);
+            u64 offset = storage.Push(v.data(), size);
             j[field] = Json::object();
             j[field]["offset"] = offset;
             j[field]["size"] = size;
             //j[field] = EncodeBase64((u8*)v.data(), v.size() * sizeof(T));
         } else if (j.contains(field)) {
             //std::vector<u8> data = DecodeBase64(j[field]);
-            uint32_t size = j[field]["size"];
-            uint32_t offset = j[field]["offset"];
+            u64 size = j[field]["size"];
+            u64 offset = j[field]["offset"];
+            if (offset + size > storage.Size()) {
+                LOG_ERROR("Binary data of '{}' out of bounds", field);
+                return;
+            }
             v.resize(size / sizeof(T));
             memcpy(v.data(), storage.Get(offset), size);
         }
     }
 
+    // bytes of a Vector field without copying them, valid while the storage lives
+    bool Bytes(const std::string& field, const u8*& data, u64& size) {
+        if (!j.contains(field)) {
+            return false;
+        }
+        size = j[field]["size"];
+        u64 offset = j[field]["offset"];
+        if (offset + size > storage.Size()) {
+            LOG_ERROR("Binary data of '{}' out of bounds", field);
+            return false;
+        }
+        data = storage.Get(offset);
+        return true;
+    }
+
     template<typename T>
     void VectorRef(const std::string& field, std::vector<T>& v) {
          if (dir == SAVE) {
@@ -0,0 +1,162 @@
+#include "Luzpch.hpp"
+
+#include "StaticBatching.hpp"
+#include "MeshProcessing.hpp"
+#include "ThreadPool.hpp"
+
+#include <map>
+
+namespace StaticBatching {
+
+bool CanBatch(const MeshNode& node) {
+    return node.isStatic && node.mesh && !node.mesh->indices.empty() && node.mesh->vertices.size() <= MaxSourceVertices;
+}
+
+u64 Signature(const std::vector<Ref<MeshNode>>& nodes, float cellSize) {
+    struct NodeKey {
+        UUID node;
+        UUID mesh;
+        UUID material;
+        u64 batchable;
+    };
+    std::vector<NodeKey> keys(nodes.size());
+    for (size_t i = 0; i < nodes.size(); i++) {
+        const MeshNode& node = *nodes[i];
+        keys[i] = { node.uuid, node.mesh ? node.mesh->uuid : 0, node.material ? node.material->uuid : 0, CanBatch(node) };
+    }
+    return Hash64(keys.data(), keys.size() * sizeof(NodeKey), Hash64(&cellSize, sizeof(cellSize)));
+}
+
+std::vector<Batch> Build(const std::vector<Ref<MeshNode>>& nodes, const std::vector<glm::mat4>& transforms, float cellSize) {
+    LUZ_PROFILE_NAMED("StaticBatching::Build");
+    // packed and unpacked meshes use different vertex layouts and can't share a buffer
+    using Key = std::tuple<UUID, bool, i32, i32, i32>;
+    std::map<Key, std::vector<u32>> groups;
+    for (u32 i = 0; i < nodes.size(); i++) {
+        const MeshNode& node = *nodes[i];
+        if (!CanBatch(node)) {
+            continue;
+        }
+        glm::vec3 center = transforms[i] * glm::vec4(node.mesh->sphereCenter, 1.0f);
+        glm::ivec3 cell = glm::floor(center / std::max(cellSize, 0.001f));
+        groups[{ node.material ? node.material->uuid : 0, node.mesh->packedVertices, cell.x, cell.y, cell.z }].push_back(i);
+    }
+    std::vector<Batch> batches;
+    for (const auto& [key, members] : groups) {
+        size_t first = batches.size();
+        u32 vertexCount = MaxBatchVertices;
+        for (u32 index : members) {
+            u32 meshVertices = u32(nodes[index]->mesh->vertices.size());
+            if (vertexCount + meshVertices > MaxBatchVertices) {
+                batches.emplace_back();
+                vertexCount = 0;
+            }
+            batches.back().sources.push_back(index);
+            vertexCount += meshVertices;
+        }
+        // a single node gains nothing from being merged
+        batches.erase(std::remove_if(batches.begin() + first, batches.end(), [](const Batch& batch) {
+            return batch.sources.size() < 2;
+        }), batches.end());
+    }
+    for (Batch& batch : batches) {
+        batch.node = AssetManager::CreateObject<MeshNode>("Static Batch");
+        batch.node->material = nodes[batch.sources[0]]->material;
+        batch.node->isStatic = true;
+    }
+    ThreadPool::ParallelFor(u32(batches.size()), [&](u32 i) {
+        Merge(batches[i], nodes, transforms);
+    });
+    return batches;
+}
+
+bool IsStale(const Batch& batch, const std::vector<glm::mat4>& transforms) {
+    for (size_t i = 0; i < batch.sources.size(); i++) {
+        if (transforms[batch.sources[i]] != batch.transforms[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void Merge(Batch& batch, const std::vector<Ref<MeshNode>>& nodes, const std::vector<glm::mat4>& transforms) {
+    Ref<MeshAsset> mesh = AssetManager::CreateObject<MeshAsset>("Static Batch");
+    batch.transforms.resize(batch.sources.size());
+    u32 lodCount = 1;
+    bool packed = true;
+    bool meshlets = false;
+    bool occlusion = false;
+    size_t vertexCount = 0;
+    for (u32 index : batch.sources) {
+        const MeshAsset& source = *nodes[index]->mesh;
+        lodCount = std::max(lodCount, u32(source.lods.size()));
+        packed &= source.packedVertices;
+        meshlets |= !source.meshlets.empty();
+        occlusion |= !source.occlusion.empty();
+        vertexCount += source.vertices.size();
+    }
+    mesh->packedVertices = packed;
+    mesh->vertices.reserve(vertexCount);
+
+    std::vector<u32> baseVertex(batch.sources.size());
+    std::vector<u8> mirrored(batch.sources.size());
+    std::vector<float> maxScale(batch.sources.size());
+    for (size_t i = 0; i < batch.sources.size(); i++) {
+        const MeshAsset& source = *nodes[batch.sources[i]]->mesh;
+        const glm::mat4& transform = transforms[batch.sources[i]];
+        batch.transforms[i] = transform;
+        glm::mat3 linear = glm::mat3(transform);
+        glm::mat3 normalMat = glm::transpose(glm::inverse(linear));
+        // mirroring transforms flip the winding and the bitangent
+        mirrored[i] = glm::determinant(linear) < 0.0f;
+        maxScale[i] = glm::max(glm::length(linear[0]), glm::max(glm::length(linear[1]), glm::length(linear[2])));
+        baseVertex[i] = u32(mesh->vertices.size());
+        for (const MeshAsset::MeshVertex& v : source.vertices) {
+            MeshAsset::MeshVertex& out = mesh->vertices.emplace_back(v);
+            out.position = transform * glm::vec4(v.position, 1.0f);
+            glm::vec3 normal = normalMat * v.normal;
+            glm::vec3 tangent = linear * glm::vec3(v.tangent);
+            out.normal = glm::length(normal) > 0.0f ? glm::normalize(normal) : normal;
+            out.tangent = glm::vec4(glm::length(tangent) > 0.0f ? glm::normalize(tangent) : tangent, mirrored[i] ? -v.tangent.w : v.tangent.w);
+        }
+        // sources without baked occlusion are unoccluded
+        if (occlusion && source.occlusion.size() == source.vertices.size()) {
+            mesh->occlusion.insert(mesh->occlusion.end(), source.occlusion.begin(), source.occlusion.end());
+        } else if (occlusion) {
+            mesh->occlusion.resize(mesh->vertices.size(), 255);
+        }
+    }
+    for (u32 level = 0; level < lodCount; level++) {
+        MeshAsset::Lod lod = { u32(mesh->indices.size()), 0, 0, 0, 0.0f };
+        for (size_t i = 0; i < batch.sources.size(); i++) {
+            const MeshAsset& source = *nodes[batch.sources[i]]->mesh;
+            u32 firstIndex = 0;
+            u32 indexCount = u32(source.indices.size());
+            if (!source.lods.empty()) {
+                const MeshAsset::Lod& sourceLod = source.lods[std::min(level, u32(source.lods.size()) - 1)];
+                firstIndex = sourceLod.firstIndex;
+                indexCount = sourceLod.indexCount;
+                lod.error = std::max(lod.error, sourceLod.error * maxScale[i]);
+            }
+            for (u32 t = firstIndex; t + 3 <= firstIndex + indexCount; t += 3) {
+                u32 a = source.indices[t + 0] + baseVertex[i];
+                u32 b = source.indices[t + 1] + baseVertex[i];
+                u32 c = source.indices[t + 2] + baseVertex[i];
+                mesh->indices.insert(mesh->indices.end(), { a, mirrored[i] ? c : b, mirrored[i] ? b : c });
+            }
+        }
+        lod.indexCount = u32(mesh->indices.size()) - lod.firstIndex;
+        mesh->lods.push_back(lod);
+    }
+    if (meshlets) {
+        for (MeshAsset::Lod& lod : mesh->lods) {
+            lod.firstMeshlet = u32(mesh->meshlets.size());
+            MeshProcessing::BuildMeshlets(*mesh, lod.firstIndex, lod.indexCount, mesh->meshlets);
+            lod.meshletCount = u32(mesh->meshlets.size()) - lod.firstMeshlet;
+        }
+    }
+    MeshProcessing::ComputeBounds(*mesh);
+    batch.node->mesh = mesh;
+}
+
+}
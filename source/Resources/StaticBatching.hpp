@@ -0,0 +1,36 @@
+#pragma once
+
+#include "AssetManager.hpp"
+
+namespace StaticBatching {
+
+// meshes above this size already amortize their draw, merging them would only duplicate memory
+inline constexpr u32 MaxSourceVertices = 1 << 14;
+inline constexpr u32 MaxBatchVertices = 1 << 18;
+
+// world space geometry of static nodes sharing a material, the sources stay in the scene as editable proxies
+struct Batch {
+    Ref<MeshNode> node;
+    // indices into the node list the batch was built from
+    std::vector<u32> sources;
+    // world transforms the sources were merged with, the batch is stale once any of them moves
+    std::vector<glm::mat4> transforms;
+};
+
+bool CanBatch(const MeshNode& node);
+
+// hash of every node, its mesh, material and static flag in order, equal signatures mean batches built from
+// the previous list still reference the same nodes
+u64 Signature(const std::vector<Ref<MeshNode>>& nodes, float cellSize);
+
+// groups batchable nodes by material and by the cellSize cell containing their world bounds center,
+// every group with at least two nodes is merged. transforms holds the world transform of every node
+std::vector<Batch> Build(const std::vector<Ref<MeshNode>>& nodes, const std::vector<glm::mat4>& transforms, float cellSize);
+
+bool IsStale(const Batch& batch, const std::vector<glm::mat4>& transforms);
+
+// merges the sources with their current transforms into a new mesh, lod i of the batch holds lod i of every
+// source or its coarsest one
+void Merge(Batch& batch, const std::vector<Ref<MeshNode>>& nodes, const std::vector<glm::mat4>& transforms);
+
+}
@@ -0,0 +1,495 @@
+#include "Luzpch.hpp"
+
+#include "TextureProcessing.hpp"
+#include "ThreadPool.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define LUZ_SSE2
+#endif
+
+namespace TextureProcessing {
+
+// texels are filtered as 12 bit values so dark sRGB steps don't collapse
+static constexpr u32 FilterMax = 4095;
+static constexpr u32 RowsPerTask = 16;
+
+struct FilterTables {
+    u16 srgbToLinear[256];
+    u8 linearToSRGB[FilterMax + 1];
+    u16 unormToLinear[256];
+    u8 linearToUnorm[FilterMax + 1];
+
+    FilterTables() {
+        for (u32 i = 0; i < 256; i++) {
+            float c = i / 255.0f;
+            float l = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            srgbToLinear[i] = u16(std::round(l * FilterMax));
+            unormToLinear[i] = u16(std::round(c * FilterMax));
+        }
+        for (u32 i = 0; i <= FilterMax; i++) {
+            float l = float(i) / FilterMax;
+            float c = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+            linearToSRGB[i] = u8(std::round(c * 255.0f));
+            linearToUnorm[i] = u8(std::round(l * 255.0f));
+        }
+    }
+};
+
+static const FilterTables& GetFilterTables() {
+    static FilterTables tables;
+    return tables;
+}
+
+u32 MipLevelCount(u32 width, u32 height) {
+    u32 levels = 1;
+    while ((width | height) >> levels) {
+        levels++;
+    }
+    return levels;
+}
+
+size_t LevelSize(TextureAsset::Encoding encoding, u32 width, u32 height) {
+    size_t blocks = size_t((width + 3) / 4) * ((height + 3) / 4);
+    switch (encoding) {
+    case TextureAsset::Encoding::BC1:
+    case TextureAsset::Encoding::BC4:
+        return blocks * 8;
+    case TextureAsset::Encoding::BC5:
+    case TextureAsset::Encoding::BC7:
+        return blocks * 16;
+    default:
+        return size_t(width) * height * 4;
+    }
+}
+
+size_t MipOffset(u32 width, u32 height, u32 level, TextureAsset::Encoding encoding) {
+    size_t offset = 0;
+    for (u32 i = 0; i < level; i++) {
+        offset += LevelSize(encoding, std::max(1u, width >> i), std::max(1u, height >> i));
+    }
+    return offset;
+}
+
+// decodes 2 * dstWidth pixels, repeating the last one on odd or single pixel rows
+static void DecodeRow(const u8* src, u32 srcWidth, u32 dstWidth, const u16* decodeColor, const u16* decodeAlpha, u16* out) {
+    for (u32 x = 0; x < dstWidth * 2; x++) {
+        const u8* pixel = src + std::min(x, srcWidth - 1) * 4;
+        out[x * 4 + 0] = decodeColor[pixel[0]];
+        out[x * 4 + 1] = decodeColor[pixel[1]];
+        out[x * 4 + 2] = decodeColor[pixel[2]];
+        out[x * 4 + 3] = decodeAlpha[pixel[3]];
+    }
+}
+
+// averages 2x2 blocks of the two decoded rows into dstWidth pixels
+static void FilterRows(const u16* row0, const u16* row1, u32 dstWidth, u16* out) {
+    u32 x = 0;
+#ifdef LUZ_SSE2
+    // 2 output pixels per iteration, sums stay below 4 * FilterMax so 16 bits are enough
+    const __m128i round = _mm_set1_epi16(2);
+    for (; x + 2 <= dstWidth; x += 2) {
+        __m128i s0 = _mm_add_epi16(_mm_loadu_si128((const __m128i*)(row0 + x * 8)), _mm_loadu_si128((const __m128i*)(row1 + x * 8)));
+        __m128i s1 = _mm_add_epi16(_mm_loadu_si128((const __m128i*)(row0 + x * 8 + 8)), _mm_loadu_si128((const __m128i*)(row1 + x * 8 + 8)));
+        __m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(s0, s1), _mm_unpackhi_epi64(s0, s1));
+        _mm_storeu_si128((__m128i*)(out + x * 4), _mm_srli_epi16(_mm_add_epi16(sum, round), 2));
+    }
+#endif
+    for (; x < dstWidth; x++) {
+        for (u32 c = 0; c < 4; c++) {
+            out[x * 4 + c] = u16((row0[x * 8 + c] + row0[x * 8 + 4 + c] + row1[x * 8 + c] + row1[x * 8 + 4 + c] + 2) >> 2);
+        }
+    }
+}
+
+static void DownsampleColor(const u8* src, u32 srcWidth, u32 srcHeight, u8* dst, u32 dstWidth, u32 dstHeight, bool srgb) {
+    const FilterTables& tables = GetFilterTables();
+    const u16* decodeColor = srgb ? tables.srgbToLinear : tables.unormToLinear;
+    const u8* encodeColor = srgb ? tables.linearToSRGB : tables.linearToUnorm;
+    u32 tasks = (dstHeight + RowsPerTask - 1) / RowsPerTask;
+    ThreadPool::ParallelFor(tasks, [&](u32 task) {
+        std::vector<u16> row0(dstWidth * 8);
+        std::vector<u16> row1(dstWidth * 8);
+        std::vector<u16> filtered(dstWidth * 4);
+        u32 end = std::min(dstHeight, (task + 1) * RowsPerTask);
+        for (u32 y = task * RowsPerTask; y < end; y++) {
+            DecodeRow(src + size_t(std::min(y * 2, srcHeight - 1)) * srcWidth * 4, srcWidth, dstWidth, decodeColor, tables.unormToLinear, row0.data());
+            DecodeRow(src + size_t(std::min(y * 2 + 1, srcHeight - 1)) * srcWidth * 4, srcWidth, dstWidth, decodeColor, tables.unormToLinear, row1.data());
+            FilterRows(row0.data(), row1.data(), dstWidth, filtered.data());
+            u8* out = dst + size_t(y) * dstWidth * 4;
+            for (u32 x = 0; x < dstWidth; x++) {
+                out[x * 4 + 0] = encodeColor[filtered[x * 4 + 0]];
+                out[x * 4 + 1] = encodeColor[filtered[x * 4 + 1]];
+                out[x * 4 + 2] = encodeColor[filtered[x * 4 + 2]];
+                out[x * 4 + 3] = tables.linearToUnorm[filtered[x * 4 + 3]];
+            }
+        }
+    });
+}
+
+static void DownsampleNormals(const u8* src, u32 srcWidth, u32 srcHeight, u8* dst, u32 dstWidth, u32 dstHeight) {
+    u32 tasks = (dstHeight + RowsPerTask - 1) / RowsPerTask;
+    ThreadPool::ParallelFor(tasks, [&](u32 task) {
+        u32 end = std::min(dstHeight, (task + 1) * RowsPerTask);
+        for (u32 y = task * RowsPerTask; y < end; y++) {
+            for (u32 x = 0; x < dstWidth; x++) {
+                glm::vec3 normal = glm::vec3(0.0f);
+                u32 alpha = 0;
+                for (u32 k = 0; k < 4; k++) {
+                    u32 sx = std::min(x * 2 + (k & 1), srcWidth - 1);
+                    u32 sy = std::min(y * 2 + (k >> 1), srcHeight - 1);
+                    const u8* pixel = src + (size_t(sy) * srcWidth + sx) * 4;
+                    normal += glm::vec3(pixel[0], pixel[1], pixel[2]) / 127.5f - 1.0f;
+                    alpha += pixel[3];
+                }
+                float length = glm::length(normal);
+                normal = length > 0.0f ? normal / length : glm::vec3(0, 0, 1);
+                u8* out = dst + (size_t(y) * dstWidth + x) * 4;
+                out[0] = u8(std::round((normal.x * 0.5f + 0.5f) * 255.0f));
+                out[1] = u8(std::round((normal.y * 0.5f + 0.5f) * 255.0f));
+                out[2] = u8(std::round((normal.z * 0.5f + 0.5f) * 255.0f));
+                out[3] = u8((alpha + 2) / 4);
+            }
+        }
+    });
+}
+
+void GenerateMips(TextureAsset& texture) {
+    if (texture.encoding != TextureAsset::Encoding::RGBA8 || texture.channels != 4 || texture.width <= 0 || texture.height <= 0) {
+        return;
+    }
+    u32 width = u32(texture.width);
+    u32 height = u32(texture.height);
+    u32 levels = MipLevelCount(width, height);
+    texture.data.resize(MipOffset(width, height, levels));
+    for (u32 level = 1; level < levels; level++) {
+        const u8* src = texture.data.data() + MipOffset(width, height, level - 1);
+        u8* dst = texture.data.data() + MipOffset(width, height, level);
+        u32 srcWidth = std::max(1u, width >> (level - 1));
+        u32 srcHeight = std::max(1u, height >> (level - 1));
+        u32 dstWidth = std::max(1u, width >> level);
+        u32 dstHeight = std::max(1u, height >> level);
+        if (texture.content == TextureAsset::Content::Normal) {
+            DownsampleNormals(src, srcWidth, srcHeight, dst, dstWidth, dstHeight);
+        } else {
+            DownsampleColor(src, srcWidth, srcHeight, dst, dstWidth, dstHeight, texture.content == TextureAsset::Content::Color);
+        }
+    }
+    texture.mipLevels = int(levels);
+}
+
+// 4x4 block of RGBA8 texels, blocks crossing the border repeat the last row and column
+static void FetchBlock(const u8* src, u32 width, u32 height, u32 bx, u32 by, glm::vec4 texels[16]) {
+    for (u32 i = 0; i < 16; i++) {
+        u32 x = std::min(bx * 4 + (i & 3), width - 1);
+        u32 y = std::min(by * 4 + (i >> 2), height - 1);
+        const u8* pixel = src + (size_t(y) * width + x) * 4;
+        texels[i] = glm::vec4(pixel[0], pixel[1], pixel[2], pixel[3]);
+    }
+}
+
+// endpoints along the principal axis of the texels, mask selects the channels taking part
+static void PrincipalEndpoints(const glm::vec4 texels[16], const glm::vec4& mask, glm::vec4& lo, glm::vec4& hi) {
+    glm::vec4 mean = glm::vec4(0.0f);
+    for (u32 i = 0; i < 16; i++) {
+        mean += texels[i] * mask;
+    }
+    mean /= 16.0f;
+    glm::mat4 covariance = glm::mat4(0.0f);
+    glm::vec4 minTexel = glm::vec4(FLT_MAX);
+    glm::vec4 maxTexel = glm::vec4(-FLT_MAX);
+    for (u32 i = 0; i < 16; i++) {
+        glm::vec4 d = texels[i] * mask - mean;
+        covariance += glm::outerProduct(d, d);
+        minTexel = glm::min(minTexel, texels[i] * mask);
+        maxTexel = glm::max(maxTexel, texels[i] * mask);
+    }
+    glm::vec4 axis = maxTexel - minTexel;
+    for (u32 i = 0; i < 8; i++) {
+        glm::vec4 next = covariance * axis;
+        float length = glm::length(next);
+        if (length < 1e-6f) {
+            break;
+        }
+        axis = next / length;
+    }
+    float axisLength = glm::length(axis);
+    if (axisLength < 1e-6f) {
+        lo = mean;
+        hi = mean;
+        return;
+    }
+    axis /= axisLength;
+    float minT = FLT_MAX;
+    float maxT = -FLT_MAX;
+    for (u32 i = 0; i < 16; i++) {
+        float t = glm::dot(texels[i] * mask - mean, axis);
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+    lo = glm::clamp(mean + axis * minT, 0.0f, 255.0f);
+    hi = glm::clamp(mean + axis * maxT, 0.0f, 255.0f);
+}
+
+// least squares endpoints for texels reconstructed as a * (1 - w) + b * w, keeps a and b when the system is singular
+static void RefineEndpoints(const glm::vec4 texels[16], const float weights[16], glm::vec4& a, glm::vec4& b) {
+    float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+    glm::vec4 ax = glm::vec4(0.0f);
+    glm::vec4 bx = glm::vec4(0.0f);
+    for (u32 i = 0; i < 16; i++) {
+        float w = weights[i];
+        aa += (1.0f - w) * (1.0f - w);
+        ab += (1.0f - w) * w;
+        bb += w * w;
+        ax += (1.0f - w) * texels[i];
+        bx += w * texels[i];
+    }
+    float det = aa * bb - ab * ab;
+    if (std::abs(det) < 1e-6f) {
+        return;
+    }
+    a = glm::clamp((bb * ax - ab * bx) / det, 0.0f, 255.0f);
+    b = glm::clamp((aa * bx - ab * ax) / det, 0.0f, 255.0f);
+}
+
+static u16 To565(const glm::vec4& c) {
+    u32 r = u32(std::round(glm::clamp(c.r, 0.0f, 255.0f) * 31.0f / 255.0f));
+    u32 g = u32(std::round(glm::clamp(c.g, 0.0f, 255.0f) * 63.0f / 255.0f));
+    u32 b = u32(std::round(glm::clamp(c.b, 0.0f, 255.0f) * 31.0f / 255.0f));
+    return u16((r << 11) | (g << 5) | b);
+}
+
+static glm::vec4 From565(u16 c) {
+    u32 r = (c >> 11) & 31;
+    u32 g = (c >> 5) & 63;
+    u32 b = c & 31;
+    return glm::vec4((r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2), 0.0f);
+}
+
+static void EncodeBC1(const glm::vec4 texels[16], u8* out) {
+    const glm::vec4 mask = glm::vec4(1, 1, 1, 0);
+    glm::vec4 rgb[16];
+    for (u32 i = 0; i < 16; i++) {
+        rgb[i] = texels[i] * mask;
+    }
+    glm::vec4 a, b;
+    PrincipalEndpoints(rgb, mask, b, a);
+    // palette order of the 4 color mode: a, b, 2/3 a + 1/3 b, 1/3 a + 2/3 b
+    const float paletteWeights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+    u16 c0 = 0, c1 = 0;
+    u32 indices = 0;
+    for (u32 iteration = 0; iteration < 2; iteration++) {
+        c0 = To565(a);
+        c1 = To565(b);
+        glm::vec4 e0 = From565(c0);
+        glm::vec4 e1 = From565(c1);
+        glm::vec4 palette[4];
+        for (u32 k = 0; k < 4; k++) {
+            palette[k] = e0 * (1.0f - paletteWeights[k]) + e1 * paletteWeights[k];
+        }
+        float weights[16];
+        indices = 0;
+        for (u32 i = 0; i < 16; i++) {
+            u32 best = 0;
+            float bestError = FLT_MAX;
+            for (u32 k = 0; k < 4; k++) {
+                float error = glm::distance2(rgb[i], palette[k]);
+                if (error < bestError) {
+                    bestError = error;
+                    best = k;
+                }
+            }
+            indices |= best << (i * 2);
+            weights[i] = paletteWeights[best];
+        }
+        if (iteration == 0) {
+            RefineEndpoints(rgb, weights, a, b);
+        }
+    }
+    if (c0 < c1) {
+        // the 4 color mode needs c0 > c1, swapping endpoints swaps 0 with 1 and 2 with 3
+        std::swap(c0, c1);
+        indices ^= 0x55555555;
+    } else if (c0 == c1) {
+        indices = 0;
+    }
+    memcpy(out + 0, &c0, 2);
+    memcpy(out + 2, &c1, 2);
+    memcpy(out + 4, &indices, 4);
+}
+
+static void EncodeBC4(const glm::vec4 texels[16], u32 channel, u8* out) {
+    float minValue = 255.0f;
+    float maxValue = 0.0f;
+    for (u32 i = 0; i < 16; i++) {
+        minValue = std::min(minValue, texels[i][channel]);
+        maxValue = std::max(maxValue, texels[i][channel]);
+    }
+    u32 e0 = u32(maxValue);
+    u32 e1 = u32(minValue);
+    u64 indices = 0;
+    if (e0 > e1) {
+        // 8 value mode: e0, e1, then 6 interpolated steps from e0 to e1
+        for (u32 i = 0; i < 16; i++) {
+            float t = (e0 - texels[i][channel]) / float(e0 - e1);
+            u32 step = u32(std::round(t * 7.0f));
+            u64 index = step == 0 ? 0 : step == 7 ? 1 : step + 1;
+            indices |= index << (i * 3);
+        }
+    }
+    out[0] = u8(e0);
+    out[1] = u8(e1);
+    for (u32 i = 0; i < 6; i++) {
+        out[2 + i] = u8(indices >> (i * 8));
+    }
+}
+
+struct BlockWriter {
+    u64 bits[2] = {};
+    u32 position = 0;
+
+    void Write(u32 value, u32 count) {
+        for (u32 i = 0; i < count; i++, position++) {
+            bits[position / 64] |= u64((value >> i) & 1) << (position % 64);
+        }
+    }
+};
+
+static constexpr u32 BC7Weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+// mode 6: one subset, RGBA 7 bit endpoints with a p-bit each and 4 bit indices
+static void EncodeBC7(const glm::vec4 texels[16], u8* out) {
+    glm::vec4 a, b;
+    PrincipalEndpoints(texels, glm::vec4(1.0f), a, b);
+    glm::ivec4 bestE0, bestE1;
+    u32 bestP0 = 0, bestP1 = 0;
+    u32 bestIndices[16] = {};
+    float bestError = FLT_MAX;
+    for (u32 iteration = 0; iteration < 2; iteration++) {
+        for (u32 p = 0; p < 4; p++) {
+            u32 p0 = p & 1;
+            u32 p1 = p >> 1;
+            glm::ivec4 e0 = glm::clamp(glm::ivec4(glm::round((a - float(p0)) * 0.5f)), 0, 127) * 2 + int(p0);
+            glm::ivec4 e1 = glm::clamp(glm::ivec4(glm::round((b - float(p1)) * 0.5f)), 0, 127) * 2 + int(p1);
+            glm::vec4 palette[16];
+            for (u32 k = 0; k < 16; k++) {
+                palette[k] = glm::vec4(((64 - int(BC7Weights4[k])) * e0 + int(BC7Weights4[k]) * e1 + 32) >> 6);
+            }
+            glm::vec4 d = glm::vec4(e1 - e0);
+            float dd = glm::dot(d, d);
+            float error = 0.0f;
+            u32 indices[16];
+            for (u32 i = 0; i < 16; i++) {
+                // project on the endpoint segment and check the neighbouring steps
+                float t = dd > 0.0f ? glm::dot(texels[i] - glm::vec4(e0), d) / dd : 0.0f;
+                int guess = glm::clamp(int(std::round(t * 15.0f)), 0, 15);
+                u32 best = guess;
+                float bestTexel = FLT_MAX;
+                for (int k = std::max(guess - 1, 0); k <= std::min(guess + 1, 15); k++) {
+                    float e = glm::distance2(texels[i], palette[k]);
+                    if (e < bestTexel) {
+                        bestTexel = e;
+                        best = k;
+                    }
+                }
+                indices[i] = best;
+                error += bestTexel;
+            }
+            if (error < bestError) {
+                bestError = error;
+                bestE0 = e0;
+                bestE1 = e1;
+                bestP0 = p0;
+                bestP1 = p1;
+                memcpy(bestIndices, indices, sizeof(indices));
+            }
+        }
+        if (iteration == 0) {
+            float weights[16];
+            for (u32 i = 0; i < 16; i++) {
+                weights[i] = BC7Weights4[bestIndices[i]] / 64.0f;
+            }
+            RefineEndpoints(texels, weights, a, b);
+        }
+    }
+    // the anchor index is stored with 3 bits, so its high bit must be zero
+    if (bestIndices[0] & 8) {
+        std::swap(bestE0, bestE1);
+        std::swap(bestP0, bestP1);
+        for (u32 i = 0; i < 16; i++) {
+            bestIndices[i] = 15 - bestIndices[i];
+        }
+    }
+    BlockWriter writer;
+    writer.Write(1 << 6, 7);
+    for (u32 c = 0; c < 4; c++) {
+        writer.Write(u32(bestE0[c]) >> 1, 7);
+        writer.Write(u32(bestE1[c]) >> 1, 7);
+    }
+    writer.Write(bestP0, 1);
+    writer.Write(bestP1, 1);
+    writer.Write(bestIndices[0], 3);
+    for (u32 i = 1; i < 16; i++) {
+        writer.Write(bestIndices[i], 4);
+    }
+    memcpy(out, writer.bits, 16);
+}
+
+TextureAsset::Encoding PickEncoding(TextureAsset::Content content) {
+    switch (content) {
+    case TextureAsset::Content::Normal:
+        return TextureAsset::Encoding::BC5;
+    case TextureAsset::Content::Occlusion:
+        return TextureAsset::Encoding::BC4;
+    case TextureAsset::Content::Data:
+        return TextureAsset::Encoding::BC1;
+    default:
+        return TextureAsset::Encoding::BC7;
+    }
+}
+
+void Compress(TextureAsset& texture) {
+    if (texture.encoding != TextureAsset::Encoding::RGBA8 || texture.channels != 4 || texture.width <= 0 || texture.height <= 0) {
+        return;
+    }
+    TextureAsset::Encoding encoding = PickEncoding(texture.content);
+    u32 width = u32(texture.width);
+    u32 height = u32(texture.height);
+    u32 levels = u32(std::max(texture.mipLevels, 1));
+    size_t blockSize = LevelSize(encoding, 4, 4);
+    std::vector<u8> compressed(MipOffset(width, height, levels, encoding));
+    for (u32 level = 0; level < levels; level++) {
+        const u8* src = texture.data.data() + MipOffset(width, height, level);
+        u8* dst = compressed.data() + MipOffset(width, height, level, encoding);
+        u32 levelWidth = std::max(1u, width >> level);
+        u32 levelHeight = std::max(1u, height >> level);
+        u32 blocksX = (levelWidth + 3) / 4;
+        u32 blocksY = (levelHeight + 3) / 4;
+        ThreadPool::ParallelFor(blocksY, [&](u32 by) {
+            glm::vec4 texels[16];
+            for (u32 bx = 0; bx < blocksX; bx++) {
+                FetchBlock(src, levelWidth, levelHeight, bx, by, texels);
+                u8* out = dst + (size_t(by) * blocksX + bx) * blockSize;
+                switch (encoding) {
+                case TextureAsset::Encoding::BC1:
+                    EncodeBC1(texels, out);
+                    break;
+                case TextureAsset::Encoding::BC4:
+                    EncodeBC4(texels, 0, out);
+                    break;
+                case TextureAsset::Encoding::BC5:
+                    EncodeBC4(texels, 0, out);
+                    EncodeBC4(texels, 1, out + 8);
+                    break;
+                default:
+                    EncodeBC7(texels, out);
+                    break;
+                }
+            }
+        });
+    }
+    texture.data.swap(compressed);
+    texture.encoding = encoding;
+}
+
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "AssetManager.hpp"
+
+namespace TextureProcessing {
+
+u32 MipLevelCount(u32 width, u32 height);
+size_t LevelSize(TextureAsset::Encoding encoding, u32 width, u32 height);
+// bytes of every level before the given one, levels are tightly packed
+size_t MipOffset(u32 width, u32 height, u32 level, TextureAsset::Encoding encoding = TextureAsset::Encoding::RGBA8);
+
+// rebuilds the mip chain after level 0 with a 2x2 box filter, color textures are filtered in linear space
+// and normal maps are renormalized
+void GenerateMips(TextureAsset& texture);
+
+// block compresses every level of an RGBA8 texture: BC7 for color, BC5 for normals, BC4 for occlusion and BC1 for data
+TextureAsset::Encoding PickEncoding(TextureAsset::Content content);
+void Compress(TextureAsset& texture);
+
+}
@@ -89,6 +89,9 @@ struct ModelBlock {
     int metallicRoughnessMap;
     int vertexBuffer;
     int indexBuffer;
+
+    int occlusionBuffer;
+    int pad[3];
 };
 
 struct SceneBlock {
@@ -256,6 +259,10 @@ layout(set = 0, binding = LUZ_BINDING_BUFFER) readonly buffer IndexBuffer {
     uint indices[];
 } indexBuffers[];
 
+layout(set = 0, binding = LUZ_BINDING_BUFFER) readonly buffer OcclusionBuffer {
+    uint data[];
+} occlusionBuffers[];
+
 layout(set = 0, binding = LUZ_BINDING_TLAS) uniform accelerationStructureEXT tlasBuffer[];
 layout(binding = LUZ_BINDING_STORAGE_IMAGE) uniform image2D images[];
 
@@ -265,4 +272,21 @@ layout(binding = LUZ_BINDING_STORAGE_IMAGE) uniform image2D images[];
 #define vertexBuffer vertexBuffers[model.vertexBuffer]
 #define lineBlocks lineBuffers[ctx.linesRID].data
 
+vec3 OctDecode(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.x += n.x >= 0.0 ? -t : t;
+    n.y += n.y >= 0.0 ? -t : t;
+    return normalize(n);
+}
+
+// baked ambient occlusion of a vertex, four bytes per uint. -1 when the model wasn't baked
+float BakedOcclusion(int buffer, uint vertex) {
+    if (buffer < 0) {
+        return -1.0;
+    }
+    uint word = occlusionBuffers[buffer].data[vertex >> 2];
+    return float((word >> ((vertex & 3u) * 8u)) & 0xFFu) / 255.0;
+}
+
 #endif
\ No newline at end of file
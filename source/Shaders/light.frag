@@ -228,7 +228,7 @@ void main() {
 
     float shadowBias = length(fragPos - scene.camPos) * 0.01;
     vec3 shadowOrigin = fragPos.xyz + N*shadowBias;
-    float rayTracedAo = TraceAORays(shadowOrigin, N);
+    float rayTracedAo = material.a > 0.5 ? TraceAORays(shadowOrigin, N) : 1.0;
     vec3 ambient = scene.ambientLightColor*scene.ambientLightIntensity*albedo.rgb*occlusion*rayTracedAo;
     vec3 color = ambient + Lo + emission.rgb;
     outColor = vec4(color, 1.0);
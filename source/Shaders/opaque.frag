@@ -12,6 +12,7 @@ layout(location = 0) in vec3 fragNormal;
 layout(location = 1) in vec3 fragTangent;
 layout(location = 2) in vec2 fragTexCoord;
 layout(location = 3) in mat3 fragTBN;
+layout(location = 6) in float fragOcclusion;
 
 layout(location = 0) out vec4 outAlbedo;
 layout(location = 1) out vec4 outNormal;
@@ -20,7 +21,7 @@ layout(location = 3) out vec4 outEmission;
 
 void main() {
     vec4 albedo = model.color;
-    vec3 normalSample = vec3(1, 1, 1);
+    vec2 normalSample = vec2(0, 0);
     float occlusion = 1;
     float roughness = model.roughness;
     float metallic = model.metallic;
@@ -41,19 +42,26 @@ void main() {
         occlusion = texture(textures[model.aoMap], fragTexCoord).r;
     }
     if (model.normalMap >= 0) {
-        normalSample = texture(textures[model.normalMap], fragTexCoord).rgb;
+        // z is rebuilt from xy so two channel BC5 normal maps work too
+        normalSample = texture(textures[model.normalMap], fragTexCoord).rg*2.0 - 1.0;
     }
     if (model.emissionMap >= 0) {
         emission *= texture(textures[model.emissionMap], fragTexCoord);
     }
     vec3 N;
-    if(fragTangent == vec3(0, 0, 0) || normalSample == vec3(1, 1, 1)) {
+    if(fragTangent == vec3(0, 0, 0) || model.normalMap < 0) {
         N = normalize(fragNormal); 
     } else {
-        N = normalize(fragTBN*normalize(normalSample*2.0 - 1.0));
+        N = normalize(fragTBN*vec3(normalSample, sqrt(max(0.0, 1.0 - dot(normalSample, normalSample)))));
     }
     outAlbedo = albedo; 
     outNormal = vec4(N, 1.0);
-    outMaterial = vec4(roughness, metallic, occlusion, 1.0);
+    // alpha tells the light pass to trace ao rays, baked occlusion already holds them
+    float traceOcclusion = 1.0;
+    if (fragOcclusion >= 0.0) {
+        occlusion *= fragOcclusion;
+        traceOcclusion = 0.0;
+    }
+    outMaterial = vec4(roughness, metallic, occlusion, traceOcclusion);
     outEmission = emission;
 }
\ No newline at end of file
@@ -17,6 +17,7 @@ layout(location = 0) out vec3 fragNormal;
 layout(location = 1) out vec3 fragTangent;
 layout(location = 2) out vec2 fragTexCoord;
 layout(location = 3) out mat3 fragTBN;
+layout(location = 6) out float fragOcclusion;
 
 void main() {
     vec4 fragPos = model.modelMat * vec4(inPosition, 1.0);
@@ -28,4 +29,5 @@ void main() {
     fragTangent = normalize(fragTangent - dot(fragTangent, fragNormal) * fragNormal);
     vec3 B = cross(fragNormal, fragTangent)*inTangent.w;
     fragTBN = mat3(fragTangent, B, fragNormal);
+    fragOcclusion = BakedOcclusion(model.occlusionBuffer, gl_VertexIndex);
 }
\ No newline at end of file
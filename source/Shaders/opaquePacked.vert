@@ -0,0 +1,36 @@
+#version 460
+
+#extension GL_GOOGLE_include_directive : enable
+
+#include "LuzCommon.h"
+
+layout(push_constant) uniform Constants {
+    OpaqueConstants ctx;
+};
+
+// MeshAsset::PackedVertex, the model matrix already contains the dequantization
+layout(location = 0) in vec4 inPosition;
+layout(location = 1) in vec4 inNormalTangent;
+layout(location = 2) in vec2 inTexCoord;
+
+layout(location = 0) out vec3 fragNormal;
+layout(location = 1) out vec3 fragTangent;
+layout(location = 2) out vec2 fragTexCoord;
+layout(location = 3) out mat3 fragTBN;
+layout(location = 6) out float fragOcclusion;
+
+void main() {
+    vec3 inNormal = OctDecode(inNormalTangent.xy);
+    vec3 inTangent = OctDecode(inNormalTangent.zw);
+    float tangentSign = inPosition.w < 0.0 ? -1.0 : 1.0;
+    vec4 fragPos = model.modelMat * vec4(inPosition.xyz, 1.0);
+    gl_Position = scene.viewProj * fragPos;
+    fragTexCoord = inTexCoord;
+    mat4 transposeInverseModel = transpose(inverse(model.modelMat));
+    fragTangent = normalize(vec3(transposeInverseModel*vec4(inTangent, 0.0)));
+    fragNormal = normalize(vec3(transposeInverseModel*vec4(inNormal, 0.0)));
+    fragTangent = normalize(fragTangent - dot(fragTangent, fragNormal) * fragNormal);
+    vec3 B = cross(fragNormal, fragTangent)*tangentSign;
+    fragTBN = mat3(fragTangent, B, fragNormal);
+    fragOcclusion = BakedOcclusion(model.occlusionBuffer, gl_VertexIndex);
+}
\ No newline at end of file
@@ -0,0 +1,17 @@
+#version 460
+
+#extension GL_GOOGLE_include_directive : enable
+
+#include "LuzCommon.h"
+
+layout(push_constant) uniform Constants {
+    ShadowMapConstants ctx;
+};
+
+layout(location = 0) in vec4 inPosition;
+layout(location = 1) in vec4 inNormalTangent;
+layout(location = 2) in vec2 inTexCoord;
+
+void main() {
+    gl_Position = model.modelMat * vec4(inPosition.xyz, 1.0);
+}
\ No newline at end of file
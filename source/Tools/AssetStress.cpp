@@ -0,0 +1,123 @@
+#include "Luzpch.hpp"
+
+#include "AssetManager.hpp"
+
+#include <random>
+#include <thread>
+
+// Stress benchmark of the asset registry, many threads create assets in one manager while looking up the
+// ones they created, then every thread looks up assets created by all of them.
+
+static void PrintUsage() {
+    printf("usage: luz-asset-stress [options]\n");
+    printf("  --assets <n>   assets created per round (default: 2000000)\n");
+    printf("  --threads <n>  most threads used, rounds double the count from 1 (default: hardware threads)\n");
+}
+
+struct RoundResult {
+    double createMilliseconds = 0.0;
+    double lookupMilliseconds = 0.0;
+    u64 missing = 0;
+    u64 duplicates = 0;
+    u64 wrongType = 0;
+};
+
+static RoundResult RunRound(u32 threadCount, u32 assetCount) {
+    AssetManager manager;
+    RoundResult result;
+    std::vector<std::vector<UUID>> created(threadCount);
+    std::vector<u64> missing(threadCount, 0);
+    std::vector<u64> wrongType(threadCount, 0);
+    const auto run = [&](auto&& func) {
+        std::vector<std::thread> threads;
+        for (u32 t = 1; t < threadCount; t++) {
+            threads.emplace_back(func, t);
+        }
+        func(0);
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    };
+
+    auto start = std::chrono::high_resolution_clock::now();
+    run([&](u32 t) {
+        u32 first = u64(assetCount) * t / threadCount;
+        u32 last = u64(assetCount) * (t + 1) / threadCount;
+        std::vector<UUID>& uuids = created[t];
+        uuids.reserve(last - first);
+        std::mt19937 random(t);
+        for (u32 i = first; i < last; i++) {
+            Ref<Asset> asset;
+            if (i % 2) {
+                asset = manager.CreateAsset<MaterialAsset>("Material");
+            } else {
+                asset = manager.CreateAsset<TextureAsset>("Texture");
+            }
+            uuids.push_back(asset->uuid);
+            // lookups mixed with insertions hit shards other threads are writing to
+            UUID earlier = uuids[random() % uuids.size()];
+            missing[t] += manager.Get(earlier) == nullptr;
+        }
+    });
+    result.createMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+    run([&](u32 t) {
+        for (u32 other = 0; other < threadCount; other++) {
+            const std::vector<UUID>& uuids = created[(t + other) % threadCount];
+            for (size_t i = 0; i < uuids.size(); i += threadCount) {
+                bool texture = manager.Get<TextureAsset>(uuids[i]) != nullptr;
+                bool material = manager.Get<MaterialAsset>(uuids[i]) != nullptr;
+                missing[t] += !texture && !material;
+                wrongType[t] += texture && material;
+            }
+        }
+    });
+    result.lookupMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+    std::vector<UUID> all;
+    all.reserve(assetCount);
+    for (u32 t = 0; t < threadCount; t++) {
+        all.insert(all.end(), created[t].begin(), created[t].end());
+        result.missing += missing[t];
+        result.wrongType += wrongType[t];
+    }
+    std::sort(all.begin(), all.end());
+    size_t unique = std::unique(all.begin(), all.end()) - all.begin();
+    result.duplicates = all.size() - unique;
+    result.missing += unique > manager.AssetCount() ? unique - manager.AssetCount() : 0;
+    return result;
+}
+
+int main(int argc, char** argv) {
+    Logger::Init();
+    u32 assetCount = 2000000;
+    u32 maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--assets" && i + 1 < argc) {
+            assetCount = std::max(1u, u32(std::strtoul(argv[++i], nullptr, 10)));
+        } else if (arg == "--threads" && i + 1 < argc) {
+            maxThreads = std::max(1u, u32(std::strtoul(argv[++i], nullptr, 10)));
+        } else {
+            PrintUsage();
+            return arg == "-h" || arg == "--help" ? 0 : 2;
+        }
+    }
+
+    bool failed = false;
+    for (u32 threads = 1;; threads = std::min(threads * 2, maxThreads)) {
+        RoundResult result = RunRound(threads, assetCount);
+        LOG_INFO("{:3} threads: create {:8.1f} ms ({:6.2f} M/s), lookup {:8.1f} ms ({:6.2f} M/s)", threads,
+            result.createMilliseconds, assetCount / result.createMilliseconds / 1000.0,
+            result.lookupMilliseconds, assetCount / result.lookupMilliseconds / 1000.0);
+        if (result.missing || result.duplicates || result.wrongType) {
+            LOG_ERROR("{} missing, {} duplicated uuids, {} assets of the wrong type", result.missing, result.duplicates, result.wrongType);
+            failed = true;
+        }
+        if (threads == maxThreads) {
+            break;
+        }
+    }
+    return failed ? 1 : 0;
+}
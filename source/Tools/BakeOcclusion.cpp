@@ -0,0 +1,83 @@
+#include "Luzpch.hpp"
+
+#include "AssetManager.hpp"
+#include "OcclusionBaking.hpp"
+
+// Headless ambient occlusion bake, traces the static nodes of a project's initial scene on the cpu and saves
+// the baked values back into the project.
+
+static void PrintUsage() {
+    printf("usage: luz-bake-ao [options] <project.luz>\n");
+    printf("  --bin <file>          project data (default: <project>.luzbin)\n");
+    printf("  --samples <n>         rays per vertex (default: the scene's bake samples)\n");
+    printf("  --min-distance <f>    rays start this far from the vertex (default: the scene's ao min)\n");
+    printf("  --max-distance <f>    only hits closer than this occlude (default: the scene's ao max)\n");
+    printf("  -o <project.luz>      output project, the .luzbin is written next to it (default: the input)\n");
+}
+
+int main(int argc, char** argv) {
+    Logger::Init();
+    std::filesystem::path projectPath;
+    std::filesystem::path binPath;
+    std::filesystem::path outputPath;
+    u32 samples = 0;
+    float minDistance = -1.0f;
+    float maxDistance = -1.0f;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--bin" && i + 1 < argc) {
+            binPath = argv[++i];
+        } else if (arg == "--samples" && i + 1 < argc) {
+            samples = std::max(1u, u32(std::strtoul(argv[++i], nullptr, 10)));
+        } else if (arg == "--min-distance" && i + 1 < argc) {
+            minDistance = std::max(0.0f, std::strtof(argv[++i], nullptr));
+        } else if (arg == "--max-distance" && i + 1 < argc) {
+            maxDistance = std::max(0.0f, std::strtof(argv[++i], nullptr));
+        } else if (arg == "-o" && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else if (arg == "-h" || arg == "--help") {
+            PrintUsage();
+            return 0;
+        } else if (projectPath.empty() && arg[0] != '-') {
+            projectPath = arg;
+        } else {
+            LOG_ERROR("Unsupported argument {}", arg);
+            PrintUsage();
+            return 2;
+        }
+    }
+    if (projectPath.empty()) {
+        PrintUsage();
+        return 2;
+    }
+    if (!std::filesystem::exists(projectPath)) {
+        LOG_ERROR("Project {} doesn't exist", projectPath.string());
+        return 1;
+    }
+    if (binPath.empty()) {
+        binPath = std::filesystem::path(projectPath).replace_extension(".luzbin");
+    }
+    if (outputPath.empty()) {
+        outputPath = projectPath;
+    }
+
+    AssetManager assets;
+    assets.LoadProject(projectPath, binPath);
+    Ref<SceneAsset> scene = assets.GetInitialScene();
+    OcclusionBaking::Settings settings = OcclusionBaking::SceneSettings(*scene);
+    if (samples > 0) {
+        settings.samples = samples;
+    }
+    if (minDistance >= 0.0f) {
+        settings.minDistance = minDistance;
+    }
+    if (maxDistance >= 0.0f) {
+        settings.maxDistance = maxDistance;
+    }
+    OcclusionBaking::Stats stats = OcclusionBaking::Bake(assets, scene, settings);
+    if (stats.nodes == 0) {
+        LOG_WARN("Scene {} has no static mesh nodes to bake", scene->name);
+    }
+    assets.SaveProject(outputPath, std::filesystem::path(outputPath).replace_extension(".luzbin"));
+    return 0;
+}
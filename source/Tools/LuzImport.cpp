@@ -0,0 +1,146 @@
+#include "Luzpch.hpp"
+
+#include "AssetIO.hpp"
+#include "AssetManager.hpp"
+#include "ThreadPool.hpp"
+
+// Headless importer, converts scenes and textures into a .luz/.luzbin project without a window or a gpu.
+
+static void PrintUsage() {
+    printf("usage: luz-import [options] <file or folder>...\n");
+    printf("  -o <project.luz>  output project, the .luzbin is written next to it (default: imported.luz)\n");
+    printf("  --report <file>   json report with times and counters per stage and file (default: <project>.report.json)\n");
+    printf("  --no-tangents     keep meshes without tangents as they are\n");
+    printf("  --no-optimize     skip welding and vertex cache, overdraw and fetch ordering\n");
+    printf("  --no-meshlets     skip meshlet generation\n");
+    printf("  --no-lods         skip the lod chain\n");
+    printf("  --no-pack         keep the 48 byte vertex layout\n");
+    printf("  --no-mips         skip mip generation\n");
+    printf("  --no-compress     keep textures as RGBA8\n");
+    printf("  --no-split        keep .ply scans in a single mesh\n");
+    printf("  --max-triangles <n>  split .ply scans into meshes of at most n triangles (default: 2097152)\n");
+    printf("folders are searched recursively, images next to a scene file are assumed to belong to it\n");
+}
+
+// scenes found in a folder, plus images that don't share their directory with a scene
+static void CollectFolder(const std::filesystem::path& folder, std::vector<std::filesystem::path>& files) {
+    std::vector<std::filesystem::path> scenes;
+    std::vector<std::filesystem::path> textures;
+    std::set<std::filesystem::path> sceneDirectories;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(folder)) {
+        if (!entry.is_regular_file()) {
+            continue;
+        }
+        if (AssetIO::IsScene(entry.path())) {
+            scenes.push_back(entry.path());
+            sceneDirectories.insert(entry.path().parent_path());
+        } else if (AssetIO::IsTexture(entry.path())) {
+            textures.push_back(entry.path());
+        }
+    }
+    std::sort(scenes.begin(), scenes.end());
+    std::sort(textures.begin(), textures.end());
+    files.insert(files.end(), scenes.begin(), scenes.end());
+    for (const auto& texture : textures) {
+        if (sceneDirectories.find(texture.parent_path()) == sceneDirectories.end()) {
+            files.push_back(texture);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    Logger::Init();
+    std::filesystem::path projectPath = "imported.luz";
+    std::filesystem::path reportPath;
+    AssetIO::ImportSettings settings;
+    std::vector<std::filesystem::path> files;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-o" && i + 1 < argc) {
+            projectPath = argv[++i];
+        } else if (arg == "--report" && i + 1 < argc) {
+            reportPath = argv[++i];
+        } else if (arg == "--no-tangents") {
+            settings.generateTangents = false;
+        } else if (arg == "--no-optimize") {
+            settings.optimizeMeshes = false;
+        } else if (arg == "--no-meshlets") {
+            settings.buildMeshlets = false;
+        } else if (arg == "--no-lods") {
+            settings.generateLods = false;
+        } else if (arg == "--no-pack") {
+            settings.packVertices = false;
+        } else if (arg == "--no-mips") {
+            settings.generateMips = false;
+        } else if (arg == "--no-compress") {
+            settings.compressTextures = false;
+        } else if (arg == "--no-split") {
+            settings.splitLargeMeshes = false;
+        } else if (arg == "--max-triangles" && i + 1 < argc) {
+            settings.maxMeshTriangles = std::max(1u, u32(std::strtoul(argv[++i], nullptr, 10)));
+        } else if (arg == "-h" || arg == "--help") {
+            PrintUsage();
+            return 0;
+        } else if (std::filesystem::is_directory(arg)) {
+            CollectFolder(arg, files);
+        } else if (AssetIO::IsScene(arg) || AssetIO::IsTexture(arg)) {
+            files.push_back(arg);
+        } else {
+            LOG_ERROR("Unsupported input {}", arg);
+            PrintUsage();
+            return 2;
+        }
+    }
+    if (files.empty()) {
+        PrintUsage();
+        return 2;
+    }
+
+    // every file is imported into its own manager so imports don't share state while running in parallel
+    struct FileImport {
+        AssetManager assets;
+        UUID root = 0;
+    };
+    std::vector<FileImport> imports(files.size());
+    std::vector<AssetIO::ImportReport> reports(files.size());
+    auto start = std::chrono::high_resolution_clock::now();
+    ThreadPool::ParallelFor(u32(files.size()), [&](u32 i) {
+        imports[i].root = AssetIO::Import(files[i], imports[i].assets, settings, nullptr, &reports[i]);
+    });
+    float importMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+
+    AssetManager project;
+    Ref<SceneAsset> scene = project.GetInitialScene();
+    scene->name = projectPath.stem().string();
+    project.GetMainCamera(scene);
+    int failed = 0;
+    for (u32 i = 0; i < files.size(); i++) {
+        FileImport& file = imports[i];
+        if (file.root == 0) {
+            LOG_ERROR("{:10.1f} ms  {} failed", reports[i].milliseconds, files[i].string());
+            failed++;
+            continue;
+        }
+        LOG_INFO("{:10.1f} ms  {}", reports[i].milliseconds, files[i].string());
+        if (Ref<SceneAsset> imported = file.assets.Get<SceneAsset>(file.root)) {
+            for (auto& node : imported->nodes) {
+                scene->Add(Node::Clone(node));
+            }
+        }
+        project.Merge(file.assets);
+    }
+
+    std::filesystem::path binPath = std::filesystem::path(projectPath).replace_extension(".luzbin");
+    auto saveStart = std::chrono::high_resolution_clock::now();
+    project.SaveProject(projectPath, binPath);
+    float saveMilliseconds = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - saveStart).count();
+    LOG_INFO("Imported {} of {} files in {:.1f} ms on {} threads, saved {} in {:.1f} ms", files.size() - failed, files.size(),
+        importMilliseconds, ThreadPool::WorkerCount() + 1, projectPath.string(), saveMilliseconds);
+
+    if (reportPath.empty()) {
+        reportPath = projectPath.parent_path() / (projectPath.stem().string() + ".report.json");
+    }
+    AssetIO::WriteFile(reportPath, AssetIO::ReportJson(reports, importMilliseconds));
+    LOG_INFO("Wrote import report {}", reportPath.string());
+    return failed ? 1 : 0;
+}